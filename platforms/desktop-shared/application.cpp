@@ -24,6 +24,8 @@
 #include "gui.h"
 #include "config.h"
 #include "renderer.h"
+#include "library.h"
+#include "pacing.h"
 
 #define APPLICATION_IMPORT
 #include "application.h"
@@ -42,6 +44,8 @@ static void sdl_shortcuts_gui(const SDL_Event* event);
 static void run_emulator(void);
 static void render(void);
 static void frame_throttle(void);
+static float frame_min_time(void);
+static bool frame_delay_enabled(void);
 
 int application_init(const char* arg)
 {
@@ -58,6 +62,8 @@ int application_init(const char* arg)
     config_read();
 
     emu_init(config_root_path);
+
+    library_init(config_root_path, config_emulator.library_path.c_str(), config_emulator.library_recursive);
     
     gui_init();
 
@@ -69,7 +75,7 @@ int application_init(const char* arg)
 
     if (IsValidPointer(arg) && (strlen(arg) > 0))
     {
-        gui_load_rom(arg);
+        gui_load_rom(arg, -1);
     }
 
     return ret;
@@ -77,23 +83,25 @@ int application_init(const char* arg)
 
 void application_destroy(void)
 {
+    library_destroy();
     config_write();
     config_destroy();
     renderer_destroy();
     gui_destroy();
     emu_destroy();
     sdl_destroy();
+    Log_flush();
 }
 
 void application_mainloop(void)
 {
     while (running)
     {
-        frame_time_start = SDL_GetPerformanceCounter();
+        pacing_wait_frame_delay();
+        frame_time_start = pacing_now();
         sdl_events();
         run_emulator();
         render();
-        frame_time_end = SDL_GetPerformanceCounter();
         frame_throttle();
     }
 }
@@ -129,6 +137,8 @@ static int sdl_init(void)
 
     SDL_SetWindowMinimumSize(sdl_window, 770, 600);
 
+    pacing_init(sdl_window);
+
     application_gamepad_mappings = SDL_GameControllerAddMappingsFromRW(SDL_RWFromFile("gamecontrollerdb.txt", "rb"), 1);
 
     if (application_gamepad_mappings > 0)
@@ -474,12 +484,14 @@ static void run_emulator(void)
             i = 0;
 
             char title[256];
-            sprintf(title, "%s %s - %s", GEARSYSTEM_TITLE, GEARSYSTEM_VERSION, emu_get_core()->GetCartridge()->GetFileName());
+            sprintf(title, "%s %s - %s", GEARSYSTEM_TITLE, GEARSYSTEM_VERSION, emu_get_file_name());
             SDL_SetWindowTitle(sdl_window, title);
         }
     }
     config_emulator.paused = emu_is_paused();
     emu_audio_sync = config_audio.sync;
+    emu_frame_time = frame_min_time();
+    emu_frame_lock = frame_delay_enabled();
     emu_update();
 }
 
@@ -491,39 +503,78 @@ static void render(void)
     renderer_render();
     renderer_end_render();
 
+    frame_time_end = pacing_now();
+
     SDL_GL_SwapWindow(sdl_window);
+
+    // Input is read and the next frame emulated as late as the GUI work allows
+    pacing_frame_presented(pacing_elapsed(frame_time_start, frame_time_end), frame_delay_enabled());
 }
 
 static void frame_throttle(void)
 {
-    if (emu_is_empty() || emu_is_paused() || config_emulator.ffwd)
+    if (!config_debug.debug || emu_is_empty() || emu_is_paused() || config_emulator.ffwd)
     {
-        float elapsed = (float)((frame_time_end - frame_time_start) * 1000) / SDL_GetPerformanceFrequency();
+        float min;
 
-        float min = 16.666f;
-
-        if (config_emulator.ffwd)
+        if (config_debug.debug)
+            min = frame_min_time();
+        else if (config_video.sync && !config_emulator.ffwd)
         {
-            switch (config_emulator.ffwd_speed)
-            {
-                case 0:
-                    min = 16.666f / 1.5f;
-                    break;
-                case 1: 
-                    min = 16.666f / 2.0f;
-                    break;
-                case 2:
-                    min = 16.666f / 2.5f;
-                    break;
-                case 3:
-                    min = 16.666f / 3.0f;
-                    break;
-                default:
-                    min = 0.0f;
-            }
+            // Swaps already wait for the display, this only catches
+            // drivers that ignore the swap interval
+            min = pacing_display_frame_time() * 0.9f;
+        }
+        else
+        {
+            // The emulation paces itself on its own thread and the GUI
+            // only has to stay under the display rate
+            min = pacing_display_frame_time();
         }
 
-        if (elapsed < min)
-            SDL_Delay((Uint32)(min - elapsed));
+        pacing_wait(frame_time_start, min);
+    }
+}
+
+static float frame_min_time(void)
+{
+    GS_RuntimeInfo runtime;
+    emu_get_runtime(runtime);
+
+    float min = 1000.0f / ((runtime.region == Region_PAL) ? GS_FRAMES_PER_SECOND_PAL : GS_FRAMES_PER_SECOND_NTSC);
+
+    if (config_emulator.ffwd)
+    {
+        switch (config_emulator.ffwd_speed)
+        {
+            case 0:
+                min /= 1.5f;
+                break;
+            case 1: 
+                min /= 2.0f;
+                break;
+            case 2:
+                min /= 2.5f;
+                break;
+            case 3:
+                min /= 3.0f;
+                break;
+            default:
+                min = 0.0f;
+        }
     }
+
+    return min;
+}
+
+// Frames are only started from the display clock when it runs at the
+// emulated rate, a 60 Hz display would speed up a 50 Hz game otherwise
+static bool frame_delay_enabled(void)
+{
+    if (!config_video.frame_delay || !config_video.sync || config_emulator.ffwd || config_debug.debug)
+        return false;
+
+    float ratio = pacing_display_frame_time() / frame_min_time();
+
+    return (ratio > 0.98f) && (ratio < 1.02f);
 }
@@ -100,6 +100,9 @@ void config_read(void)
     config_debug.show_memory = read_bool("Debug", "Memory", true);
     config_debug.show_processor = read_bool("Debug", "Processor", true);
     config_debug.show_video = read_bool("Debug", "Video", false);
+    config_debug.show_profiler = read_bool("Debug", "Profiler", false);
+    config_debug.show_vdp_timeline = read_bool("Debug", "VDPTimeline", false);
+    config_debug.show_frame_stats = read_bool("Debug", "FrameStats", false);
     config_debug.font_size = read_int("Debug", "FontSize", 0);
     
     config_emulator.ffwd_speed = read_int("Emulator", "FFWD", 1);
@@ -110,6 +113,8 @@ void config_read(void)
     config_emulator.zone = read_int("Emulator", "Zone", 0);
     config_emulator.mapper = read_int("Emulator", "Mapper", 0);
     config_emulator.region = read_int("Emulator", "Region", 0);
+    config_emulator.library_path = read_string("Emulator", "LibraryPath");
+    config_emulator.library_recursive = read_bool("Emulator", "LibraryRecursive", true);
 
     for (int i = 0; i < config_max_recent_roms; i++)
     {
@@ -126,6 +131,7 @@ void config_read(void)
     config_video.scanlines = read_bool("Video", "Scanlines", true);
     config_video.scanlines_intensity = read_float("Video", "ScanlinesIntensity", 0.40f);
     config_video.sync = read_bool("Video", "Sync", true);
+    config_video.frame_delay = read_bool("Video", "FrameDelay", false);
     
     config_audio.enable = read_bool("Audio", "Enable", true);
     config_audio.sync = read_bool("Audio", "Sync", true);
@@ -179,6 +185,9 @@ void config_write(void)
     write_bool("Debug", "Memory", config_debug.show_memory);
     write_bool("Debug", "Processor", config_debug.show_processor);
     write_bool("Debug", "Video", config_debug.show_video);
+    write_bool("Debug", "Profiler", config_debug.show_profiler);
+    write_bool("Debug", "VDPTimeline", config_debug.show_vdp_timeline);
+    write_bool("Debug", "FrameStats", config_debug.show_frame_stats);
     write_int("Debug", "FontSize", config_debug.font_size);
 
     write_int("Emulator", "FFWD", config_emulator.ffwd_speed);
@@ -189,6 +198,8 @@ void config_write(void)
     write_int("Emulator", "Zone", config_emulator.zone);
     write_int("Emulator", "Mapper", config_emulator.mapper);
     write_int("Emulator", "Region", config_emulator.region);
+    write_string("Emulator", "LibraryPath", config_emulator.library_path);
+    write_bool("Emulator", "LibraryRecursive", config_emulator.library_recursive);
 
     for (int i = 0; i < config_max_recent_roms; i++)
     {
@@ -205,6 +216,7 @@ void config_write(void)
     write_bool("Video", "Scanlines", config_video.scanlines);
     write_float("Video", "ScanlinesIntensity", config_video.scanlines_intensity);
     write_bool("Video", "Sync", config_video.sync);
+    write_bool("Video", "FrameDelay", config_video.frame_delay);
 
     write_bool("Audio", "Enable", config_audio.enable);
     write_bool("Audio", "Sync", config_audio.sync);
@@ -47,6 +47,9 @@ struct config_Emulator
     int mapper = 0;
     int region = 0;
     bool show_info = false;
+    bool show_library = false;
+    std::string library_path;
+    bool library_recursive = true;
     std::string recent_roms[config_max_recent_roms];
 };
 
@@ -61,6 +64,7 @@ struct config_Video
     bool scanlines = true;
     float scanlines_intensity = 0.40f;
     bool sync = true;
+    bool frame_delay = false;
 };
 
 struct config_Audio
@@ -98,6 +102,9 @@ struct config_Debug
     bool show_processor = true;
     bool show_memory = true;
     bool show_video = false;
+    bool show_profiler = false;
+    bool show_vdp_timeline = false;
+    bool show_frame_stats = false;
     int font_size = 0;
 };
 
@@ -17,34 +17,104 @@
  *
  */
 
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include "../../src/gearsystem.h"
 #include "../audio-shared/Sound_Queue.h"
+#include "config.h"
+#include "pacing.h"
 
 #define EMU_IMPORT
 #include "emu.h"
 
+#define EMU_FRAME_FRESH 0x04
+#define EMU_INPUT_QUEUE_SIZE 64
+#define EMU_AUDIO_SAMPLES_PER_SECOND (44100 * 2)
+#define EMU_AUDIO_FADE_IN 128
+
+struct emu_Frame
+{
+    GS_Color* buffer;
+    GS_RuntimeInfo runtime;
+};
+
+struct emu_Input
+{
+    GS_Joypads pad;
+    GS_Keys key;
+    bool pressed;
+};
+
 static GearsystemCore* gearsystem;
 static Sound_Queue* sound_queue;
 static bool save_files_in_rom_dir = false;
 static s16* audio_buffer;
+static s16* thread_audio_buffer;
+static std::thread core_thread;
+static std::recursive_mutex core_mutex;
+static std::condition_variable_any core_cond;
+static std::atomic<int> sync_pending(0);
+static std::mutex audio_mutex;
+static bool thread_quit = false;
+static bool threaded = false;
+static bool thread_audio_sync = true;
+static float thread_frame_time = 0.0f;
+static bool thread_ffwd = false;
+static bool thread_locked = false;
+static bool frame_request = false;
+static double ffwd_audio_credit = 0.0;
+static bool ffwd_audio_dropped = false;
+static emu_Frame frames[3];
+static int frame_front = 0;
+static int frame_back = 1;
+static std::atomic<int> frame_ready(2);
+static std::atomic<bool> state_paused(true);
+static std::atomic<bool> state_empty(true);
+static std::atomic<bool> state_trace(false);
+static char file_name[512];
+static emu_Input input_queue[EMU_INPUT_QUEUE_SIZE];
+static std::atomic<unsigned int> input_head(0);
+static std::atomic<unsigned int> input_tail(0);
 static char base_save_path[260];
 static bool audio_enabled;
 static bool debugging = false;
 static bool debug_step = false;
 static bool debug_next_frame = false;
-
+static u8 debug_vram_shadow[0x4000];
+static u8 debug_cram_shadow[64];
+static u8 debug_state_shadow[12];
+static GS_Color debug_sg1000_palette_shadow[16];
+static bool debug_vram_dirty[0x4000 >> 3];
+static bool debug_shadow_valid = false;
+
+static void thread_loop(void);
+static bool thread_can_run(void);
+static bool thread_has_work(void);
+static void run_frame(GS_Color* frame_buffer, s16* sample_buffer, int* sample_count);
+static void write_audio_ffwd(s16* sample_buffer, int sample_count, double elapsed);
+static void push_input(const emu_Input& input);
+static void drain_input(void);
+static void reset_frames(void);
+static void update_state(void);
 static void save_ram(void);
 static void load_ram(void);
 static const char* get_mapper(Cartridge::CartridgeTypes type);
 static const char* get_zone(Cartridge::CartridgeZones zone);
 static void init_debug(void);
 static void update_debug(void);
-static void update_debug_background_buffer_smsgg(void);
-static void update_debug_tile_buffer_smsgg(void);
-static void update_debug_sprite_buffers_smsgg(void);
-static void update_debug_background_buffer_sg1000(void);
-static void update_debug_tile_buffer_sg1000(void);
-static void update_debug_sprite_buffers_sg1000(void);
+static bool update_debug_dirty(void);
+static bool debug_vram_range_dirty(int addr, int size);
+static void debug_mark_rows(int* dirty, int first, int last);
+static void update_debug_background_buffer_smsgg(bool full);
+static void update_debug_tile_buffer_smsgg(bool full);
+static void update_debug_sprite_buffers_smsgg(bool full);
+static void update_debug_background_buffer_sg1000(bool full);
+static void update_debug_tile_buffer_sg1000(bool full);
+static void update_debug_sprite_buffers_sg1000(bool full);
 
 void emu_init(const char* save_path)
 {
@@ -52,136 +122,288 @@ void emu_init(const char* save_path)
 
     int screen_size = GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT;
 
-    emu_frame_buffer = new GS_Color[screen_size];
-    
-    for (int i=0; i < screen_size; i++)
+    for (int f = 0; f < 3; f++)
     {
-        emu_frame_buffer[i].red = 0;
-        emu_frame_buffer[i].green = 0;
-        emu_frame_buffer[i].blue = 0;
+        frames[f].buffer = new GS_Color[screen_size];
+
+        for (int i=0; i < screen_size; i++)
+        {
+            frames[f].buffer[i].red = 0;
+            frames[f].buffer[i].green = 0;
+            frames[f].buffer[i].blue = 0;
+        }
     }
 
+    emu_frame_buffer = frames[frame_front].buffer;
+
     init_debug();
 
     gearsystem = new GearsystemCore();
     gearsystem->Init();
+    file_name[0] = 0;
+    update_state();
+
+    std::string db_path = std::string(save_path) + "gamedb.dat";
+    Cartridge::LoadDatabase(db_path.c_str());
 
     sound_queue = new Sound_Queue();
     sound_queue->start(44100, 2);
 
     audio_buffer = new s16[GS_AUDIO_BUFFER_SIZE];
+    thread_audio_buffer = new s16[GS_AUDIO_BUFFER_SIZE];
 
     for (int i = 0; i < GS_AUDIO_BUFFER_SIZE; i++)
+    {
         audio_buffer[i] = 0;
+        thread_audio_buffer[i] = 0;
+    }
 
     audio_enabled = true;
     emu_audio_sync = true;
+    emu_frame_time = 0.0f;
+    emu_frame_lock = false;
     emu_debug_disable_breakpoints = false;
     emu_debug_tile_palette = 0;
+
+    reset_frames();
+
+    threaded = !config_debug.debug;
+    thread_quit = false;
+    core_thread = std::thread(thread_loop);
 }
 
 void emu_destroy(void)
 {
+    emu_sync_begin();
+    thread_quit = true;
+    emu_sync_end();
+
+    core_thread.join();
+
     save_ram();
     SafeDeleteArray(audio_buffer);
+    SafeDeleteArray(thread_audio_buffer);
     SafeDelete(sound_queue);
     SafeDelete(gearsystem);
-    SafeDeleteArray(emu_frame_buffer);
+
+    for (int f = 0; f < 3; f++)
+        SafeDeleteArray(frames[f].buffer);
+
+    emu_frame_buffer = NULL;
 }
 
-void emu_load_rom(const char* file_path, bool save_in_rom_dir, Cartridge::ForceConfiguration config)
+void emu_load_rom(const char* file_path, int zip_entry, bool save_in_rom_dir, Cartridge::ForceConfiguration config)
 {
+    emu_sync_begin();
     save_files_in_rom_dir = save_in_rom_dir;
     save_ram();
-    gearsystem->LoadROM(file_path, &config);
+    gearsystem->LoadROM(file_path, &config, zip_entry);
+    strncpy(file_name, gearsystem->GetCartridge()->GetFileName(), sizeof(file_name) - 1);
+    file_name[sizeof(file_name) - 1] = 0;
     load_ram();
+    reset_frames();
     emu_debug_continue();
+    emu_sync_end();
 }
 
 void emu_update(void)
 {
-    if (!emu_is_empty())
-    {
-        int sampleCount = 0;
+    int sampleCount = 0;
+    bool paused = false;
 
-        if (!debugging || debug_step || debug_next_frame)
-        {
-            bool breakpoints = !emu_debug_disable_breakpoints || IsValidPointer(gearsystem->GetMemory()->GetRunToBreakpoint());
+    emu_sync_begin();
 
-            if (gearsystem->RunToVBlank(emu_frame_buffer, audio_buffer, &sampleCount, debug_step, breakpoints))
-            {
-                debugging = true;
-            }
+    threaded = !config_debug.debug;
+    thread_audio_sync = emu_audio_sync;
+    thread_frame_time = emu_frame_time;
+    thread_ffwd = config_emulator.ffwd;
+    thread_locked = threaded && emu_frame_lock;
 
-            debug_next_frame = false;
-            debug_step = false;
-        }
+    if (thread_locked && thread_can_run())
+    {
+        // The lock taken by emu_sync_begin() is released while waiting,
+        // a frame that takes longer than a refresh is picked up next time
+        std::unique_lock<std::recursive_mutex> lock(core_mutex, std::adopt_lock);
+        std::chrono::microseconds timeout((long long)(pacing_display_frame_time() * 1000.0f));
+
+        frame_request = true;
+        core_cond.notify_all();
+        core_cond.wait_for(lock, timeout, [] { return !frame_request || !thread_can_run(); });
+        lock.release();
+    }
+
+    if (!threaded && !emu_is_empty())
+    {
+        frame_ready.fetch_and(~EMU_FRAME_FRESH, std::memory_order_acq_rel);
 
+        run_frame(emu_frame_buffer, audio_buffer, &sampleCount);
+        gearsystem->GetRuntimeInfo(frames[frame_front].runtime);
         update_debug();
+        paused = gearsystem->IsPaused();
+    }
 
-        if ((sampleCount > 0) && !gearsystem->IsPaused())
+    emu_sync_end();
+
+    if (threaded)
+    {
+        // Latest complete frame wins, frames the GUI had no time to show are dropped
+        if (frame_ready.load(std::memory_order_acquire) & EMU_FRAME_FRESH)
         {
-            sound_queue->write(audio_buffer, sampleCount, emu_audio_sync);
+            frame_front = frame_ready.exchange(frame_front, std::memory_order_acq_rel) & 0x03;
+            emu_frame_buffer = frames[frame_front].buffer;
         }
     }
+    else if ((sampleCount > 0) && !paused)
+    {
+        std::lock_guard<std::mutex> lock(audio_mutex);
+        sound_queue->write(audio_buffer, sampleCount, emu_audio_sync);
+    }
+}
+
+void emu_sync_begin(void)
+{
+    sync_pending.fetch_add(1, std::memory_order_acq_rel);
+    core_mutex.lock();
+    sync_pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void emu_sync_end(void)
+{
+    update_state();
+    core_mutex.unlock();
+    core_cond.notify_all();
 }
 
 void emu_key_pressed(GS_Joypads pad, GS_Keys key)
 {
-    gearsystem->KeyPressed(pad, key);
+    emu_Input input = { pad, key, true };
+    push_input(input);
 }
 
 void emu_key_released(GS_Joypads pad, GS_Keys key)
 {
-    gearsystem->KeyReleased(pad, key);
+    emu_Input input = { pad, key, false };
+    push_input(input);
 }
 
 void emu_pause(void)
 {
+    emu_sync_begin();
     gearsystem->Pause(true);
+    emu_sync_end();
 }
 
 void emu_resume(void)
 {
+    emu_sync_begin();
     gearsystem->Pause(false);
+    emu_sync_end();
 }
 
 bool emu_is_paused(void)
 {
-    return gearsystem->IsPaused();
+    return state_paused.load(std::memory_order_acquire);
 }
 
 bool emu_is_empty(void)
 {
-    return !gearsystem->GetCartridge()->IsReady();
+    return state_empty.load(std::memory_order_acquire);
 }
 
 void emu_reset(bool save_in_rom_dir, Cartridge::ForceConfiguration config)
 {
+    emu_sync_begin();
+
     save_files_in_rom_dir = save_in_rom_dir;
     save_ram();
     gearsystem->ResetROM(&config);
     load_ram();
+    reset_frames();
+
+    emu_sync_end();
 }
 
 void emu_memory_dump(void)
 {
+    emu_sync_begin();
     gearsystem->SaveMemoryDump();
+    emu_sync_end();
 }
 
 void emu_dissasemble_rom(void)
 {
+    emu_sync_begin();
     gearsystem->SaveDisassembledROM();
+    emu_sync_end();
+}
+
+void emu_enable_trace(bool enable)
+{
+    emu_sync_begin();
+
+    if (enable)
+        gearsystem->GetTracer()->Enable();
+    else
+        gearsystem->GetTracer()->Disable();
+
+    emu_sync_end();
+}
+
+bool emu_is_trace_enabled(void)
+{
+    return state_trace.load(std::memory_order_acquire);
+}
+
+const char* emu_get_file_name(void)
+{
+    return file_name;
+}
+
+// Drops any frame the emulation thread has finished but not shown yet
+void emu_clear_frame_buffer(void)
+{
+    emu_sync_begin();
+
+    frame_ready.fetch_and(~EMU_FRAME_FRESH, std::memory_order_acq_rel);
+
+    for (int i = 0; i < (GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT); i++)
+    {
+        emu_frame_buffer[i].red = 0;
+        emu_frame_buffer[i].green = 0;
+        emu_frame_buffer[i].blue = 0;
+    }
+
+    emu_sync_end();
+}
+
+void emu_save_trace(void)
+{
+    emu_sync_begin();
+
+    Cartridge* cart = gearsystem->GetCartridge();
+
+    if (cart->IsReady() && (strlen(cart->GetFilePath()) > 0))
+    {
+        std::string path = std::string(cart->GetFilePath()) + ".trace";
+        gearsystem->GetTracer()->Save(path.c_str());
+    }
+
+    emu_sync_end();
 }
 
 void emu_audio_volume(float volume)
 {
+    emu_sync_begin();
+
     audio_enabled = (volume > 0.0f);
     gearsystem->SetSoundVolume(volume);
+
+    emu_sync_end();
 }
 
 void emu_audio_reset(void)
 {
+    std::lock_guard<std::mutex> lock(audio_mutex);
     sound_queue->stop();
     sound_queue->start(44100, 2);
 }
@@ -193,62 +415,86 @@ bool emu_is_audio_enabled(void)
 
 void emu_save_ram(const char* file_path)
 {
+    emu_sync_begin();
     if (!emu_is_empty())
         gearsystem->SaveRam(file_path, true);
+    emu_sync_end();
 }
 
 void emu_load_ram(const char* file_path, bool save_in_rom_dir, Cartridge::ForceConfiguration config)
 {
+    emu_sync_begin();
+
     if (!emu_is_empty())
     {
         save_files_in_rom_dir = save_in_rom_dir;
         save_ram();
         gearsystem->ResetROM(&config);
         gearsystem->LoadRam(file_path, true);
+        reset_frames();
     }
+
+    emu_sync_end();
 }
 
 void emu_save_state_slot(int index)
 {
+    emu_sync_begin();
     if (!emu_is_empty())
         gearsystem->SaveState(index);
+    emu_sync_end();
 }
 
 void emu_load_state_slot(int index)
 {
+    emu_sync_begin();
     if (!emu_is_empty())
         gearsystem->LoadState(index);
+    emu_sync_end();
 }
 
 void emu_save_state_file(const char* file_path)
 {
+    emu_sync_begin();
     if (!emu_is_empty())
         gearsystem->SaveState(file_path, -1);
+    emu_sync_end();
 }
 
 void emu_load_state_file(const char* file_path)
 {
+    emu_sync_begin();
     if (!emu_is_empty())
         gearsystem->LoadState(file_path, -1);
+    emu_sync_end();
 }
 
 void emu_add_cheat(const char* cheat)
 {
+    emu_sync_begin();
     gearsystem->SetCheat(cheat);
+    emu_sync_end();
 }
 
 void emu_clear_cheats()
 {
+    emu_sync_begin();
     gearsystem->ClearCheats();
+    emu_sync_end();
 }
 
 void emu_get_runtime(GS_RuntimeInfo& runtime)
 {
-    gearsystem->GetRuntimeInfo(runtime);
+    if (threaded)
+        runtime = frames[frame_front].runtime;
+    else
+        gearsystem->GetRuntimeInfo(runtime);
 }
 
 void emu_get_info(char* info)
 {
+    emu_sync_begin();
+
     if (!emu_is_empty())
     {
         Cartridge* cart = gearsystem->GetCartridge();
@@ -256,6 +502,7 @@ void emu_get_info(char* info)
         gearsystem->GetRuntimeInfo(runtime);
 
         const char* filename = cart->GetFileName();
+        const char* title = (strlen(cart->GetTitle()) > 0) ? cart->GetTitle() : "Unknown";
 
         const char* system = cart->IsGameGear() ? "Game Gear" : (cart->IsSG1000() ? "SG-1000" : "Master System");
         const char* pal = cart->IsPAL() ? "PAL" : "NTSC";
@@ -265,12 +512,14 @@ void emu_get_info(char* info)
         const char* mapper = get_mapper(cart->GetType());
         const char* zone = get_zone(cart->GetZone());
 
-        sprintf(info, "File Name: %s\nMapper: %s\nRegion: %s\nSystem: %s\nRefresh Rate: %s\nCartridge Header: %s\nROM Banks: %d\nBattery: %s\nScreen Resolution: %dx%d", filename, mapper, zone, system, pal, checksum, rom_banks, battery, runtime.screen_width, runtime.screen_height);
+        sprintf(info, "File Name: %s\nTitle: %s\nCRC: %08X\nMapper: %s\nRegion: %s\nSystem: %s\nRefresh Rate: %s\nCartridge Header: %s\nROM Banks: %d\nBattery: %s\nScreen Resolution: %dx%d", filename, title, cart->GetCRC(), mapper, zone, system, pal, checksum, rom_banks, battery, runtime.screen_width, runtime.screen_height);
     }
     else
     {
         sprintf(info, "No data!");
     }
+
+    emu_sync_end();
 }
 
 GearsystemCore* emu_get_core(void)
@@ -280,22 +529,206 @@ GearsystemCore* emu_get_core(void)
 
 void emu_debug_step(void)
 {
+    emu_sync_begin();
+    threaded = !config_debug.debug;
     debugging = debug_step = true;
     debug_next_frame = false;
     gearsystem->Pause(false);
+    emu_sync_end();
 }
 
 void emu_debug_continue(void)
 {
+    emu_sync_begin();
+    threaded = !config_debug.debug;
     debugging = debug_step = debug_next_frame = false;
     gearsystem->Pause(false);
+    emu_sync_end();
 }
 
 void emu_debug_next_frame(void)
 {
+    emu_sync_begin();
+    threaded = !config_debug.debug;
     debugging = debug_next_frame = true;
     debug_step = false;
     gearsystem->Pause(false);
+    emu_sync_end();
+}
+
+static void thread_loop(void)
+{
+    std::unique_lock<std::recursive_mutex> lock(core_mutex);
+    Uint64 last = pacing_now();
+
+    while (!thread_quit)
+    {
+        if (!thread_has_work())
+        {
+            core_cond.wait(lock);
+            last = pacing_now();
+            continue;
+        }
+
+        Uint64 start = pacing_now();
+        float frame_time = thread_frame_time;
+        float elapsed = pacing_elapsed(last, start);
+        bool audio_sync = thread_audio_sync;
+        bool ffwd = thread_ffwd;
+        bool locked = thread_locked;
+        int sampleCount = 0;
+        last = start;
+
+        // Fast forward only renders the frames the GUI will get to show
+        bool render = !ffwd || !(frame_ready.load(std::memory_order_acquire) & EMU_FRAME_FRESH);
+
+        run_frame(render ? frames[frame_back].buffer : NULL, thread_audio_buffer, &sampleCount);
+
+        if (render)
+            gearsystem->GetRuntimeInfo(frames[frame_back].runtime);
+
+        bool paused = gearsystem->IsPaused();
+
+        if (render)
+            frame_back = frame_ready.exchange(frame_back | EMU_FRAME_FRESH, std::memory_order_acq_rel) & 0x03;
+
+        frame_request = false;
+
+        lock.unlock();
+        core_cond.notify_all();
+
+        if (!ffwd)
+            ffwd_audio_credit = 0.0;
+
+        if ((sampleCount > 0) && !paused)
+        {
+            std::lock_guard<std::mutex> audio_lock(audio_mutex);
+
+            if (ffwd)
+                write_audio_ffwd(thread_audio_buffer, sampleCount, elapsed / 1000.0);
+            else
+                sound_queue->write(thread_audio_buffer, sampleCount, audio_sync);
+        }
+
+        if ((frame_time > 0.0f) && !locked)
+            pacing_wait(start, frame_time);
+
+        // Let the GUI in before starting the next frame
+        while (sync_pending.load(std::memory_order_acquire) > 0)
+            std::this_thread::yield();
+
+        lock.lock();
+    }
+}
+
+static bool thread_can_run(void)
+{
+    return threaded && gearsystem->GetCartridge()->IsReady() && !gearsystem->IsPaused() && (!debugging || debug_step || debug_next_frame);
+}
+
+static bool thread_has_work(void)
+{
+    return thread_can_run() && (!thread_locked || frame_request);
+}
+
+static void run_frame(GS_Color* frame_buffer, s16* sample_buffer, int* sample_count)
+{
+    drain_input();
+
+    if (!debugging || debug_step || debug_next_frame)
+    {
+        bool breakpoints = !emu_debug_disable_breakpoints || IsValidPointer(gearsystem->GetMemory()->GetRunToBreakpoint());
+
+        if (gearsystem->RunToVBlank(frame_buffer, sample_buffer, sample_count, debug_step, breakpoints))
+        {
+            debugging = true;
+        }
+
+        debug_next_frame = false;
+        debug_step = false;
+    }
+}
+
+static void write_audio_ffwd(s16* sample_buffer, int sample_count, double elapsed)
+{
+    // Whole frames of audio are dropped so that output keeps pace with
+    // real time at the original pitch, frames after a gap fade in
+    ffwd_audio_credit += elapsed * EMU_AUDIO_SAMPLES_PER_SECOND;
+    ffwd_audio_credit = std::min(ffwd_audio_credit, 2.0 * sample_count);
+
+    if (ffwd_audio_credit < sample_count)
+    {
+        ffwd_audio_dropped = true;
+        return;
+    }
+
+    if (ffwd_audio_dropped)
+    {
+        int fade = std::min(sample_count, EMU_AUDIO_FADE_IN);
+
+        for (int i = 0; i < fade; i++)
+            sample_buffer[i] = static_cast<s16>((sample_buffer[i] * (i >> 1)) / (EMU_AUDIO_FADE_IN >> 1));
+
+        ffwd_audio_dropped = false;
+    }
+
+    ffwd_audio_credit -= sample_count;
+    sound_queue->write(sample_buffer, sample_count, true);
+}
+
+static void push_input(const emu_Input& input)
+{
+    unsigned int head = input_head.load(std::memory_order_relaxed);
+
+    if ((head - input_tail.load(std::memory_order_acquire)) >= EMU_INPUT_QUEUE_SIZE)
+    {
+        // Full while the emulation is parked, apply it right away
+        emu_sync_begin();
+        drain_input();
+        if (input.pressed)
+            gearsystem->KeyPressed(input.pad, input.key);
+        else
+            gearsystem->KeyReleased(input.pad, input.key);
+        emu_sync_end();
+        return;
+    }
+
+    input_queue[head & (EMU_INPUT_QUEUE_SIZE - 1)] = input;
+    input_head.store(head + 1, std::memory_order_release);
+}
+
+static void drain_input(void)
+{
+    unsigned int tail = input_tail.load(std::memory_order_relaxed);
+    unsigned int head = input_head.load(std::memory_order_acquire);
+
+    while (tail != head)
+    {
+        emu_Input& input = input_queue[tail & (EMU_INPUT_QUEUE_SIZE - 1)];
+
+        if (input.pressed)
+            gearsystem->KeyPressed(input.pad, input.key);
+        else
+            gearsystem->KeyReleased(input.pad, input.key);
+
+        tail++;
+    }
+
+    input_tail.store(tail, std::memory_order_release);
+}
+
+static void reset_frames(void)
+{
+    frame_ready.fetch_and(~EMU_FRAME_FRESH, std::memory_order_acq_rel);
+    gearsystem->GetRuntimeInfo(frames[frame_front].runtime);
+}
+
+// Core state the GUI polls every frame, the emulation thread never changes it
+static void update_state(void)
+{
+    state_paused.store(gearsystem->IsPaused(), std::memory_order_release);
+    state_empty.store(!gearsystem->GetCartridge()->IsReady(), std::memory_order_release);
+    state_trace.store(gearsystem->GetTracer()->IsEnabled(), std::memory_order_release);
 }
 
 static void save_ram(void)
@@ -407,69 +840,138 @@ static void init_debug(void)
         emu_debug_background_buffer[i].green = 0;
         emu_debug_background_buffer[i].blue = 0;
     }
+
+    emu_debug_background_dirty[0] = 0;
+    emu_debug_background_dirty[1] = 255;
+    emu_debug_tile_dirty[0] = 0;
+    emu_debug_tile_dirty[1] = 255;
+
+    for (int s = 0; s < 64; s++)
+        emu_debug_sprite_dirty[s] = true;
 }
 
 static void update_debug(void)
 {
+    if (!config_debug.debug || !config_debug.show_video)
+        return;
+
+    bool full = update_debug_dirty();
+
     if (gearsystem->GetVideo()->IsSG1000Mode())
     {
-        update_debug_background_buffer_sg1000();
-        update_debug_tile_buffer_sg1000();
-        update_debug_sprite_buffers_sg1000();
+        update_debug_background_buffer_sg1000(full);
+        update_debug_tile_buffer_sg1000(full);
+        update_debug_sprite_buffers_sg1000(full);
     }
     else
     {
-        update_debug_background_buffer_smsgg();
-        update_debug_tile_buffer_smsgg();
-        update_debug_sprite_buffers_smsgg();
+        update_debug_background_buffer_smsgg(full);
+        update_debug_tile_buffer_smsgg(full);
+        update_debug_sprite_buffers_smsgg(full);
     }
 }
 
-static void update_debug_background_buffer_smsgg(void)
+// VRAM is diffed against the copy taken when the views were last built,
+// any change in CRAM, modes or the table registers redraws everything
+static bool update_debug_dirty(void)
 {
     Video* video = gearsystem->GetVideo();
-    u8* regs = video->GetRegisters();
     u8* vram = video->GetVRAM();
+    u8 state[12];
+
+    // Scroll and line counter registers do not change the views
+    memcpy(state, video->GetRegisters(), 8);
+    state[8] = video->IsSG1000Mode() ? 1 : 0;
+    state[9] = video->IsExtendedMode224() ? 1 : 0;
+    state[10] = (u8)(video->GetSG1000Mode() >> 8);
+    state[11] = (u8)emu_debug_tile_palette;
 
-    for (int y = 0; y < 256; y++)
+    bool full = !debug_shadow_valid;
+    full |= (memcmp(state, debug_state_shadow, sizeof(state)) != 0);
+    full |= (memcmp(video->GetCRAM(), debug_cram_shadow, sizeof(debug_cram_shadow)) != 0);
+    full |= (memcmp(video->GetSG1000Palette(), debug_sg1000_palette_shadow, sizeof(debug_sg1000_palette_shadow)) != 0);
+
+    for (int block = 0; block < (0x4000 >> 3); block++)
     {
-        int width_y = (y * 256);
-        int tile_y = y / 8;
-        int offset_y = y & 0x7;
+        int addr = block << 3;
+        debug_vram_dirty[block] = (memcmp(vram + addr, debug_vram_shadow + addr, 8) != 0);
+    }
 
-        for (int x = 0; x < 256; x++)
-        {
-            int tile_x = x / 8;
-            int offset_x = x & 0x7;
-            int pixel = width_y + x;
+    memcpy(debug_state_shadow, state, sizeof(state));
+    memcpy(debug_cram_shadow, video->GetCRAM(), sizeof(debug_cram_shadow));
+    memcpy(debug_sg1000_palette_shadow, video->GetSG1000Palette(), sizeof(debug_sg1000_palette_shadow));
+    memcpy(debug_vram_shadow, vram, 0x4000);
+    debug_shadow_valid = true;
 
-            int name_table_addr = (regs[2] & (video->IsExtendedMode224() ? 0x0C : 0x0E)) << 10;
-            if (video->IsExtendedMode224())
-                name_table_addr |= 0x700;
+    return full;
+}
+
+static bool debug_vram_range_dirty(int addr, int size)
+{
+    for (int block = (addr >> 3); block <= ((addr + size - 1) >> 3); block++)
+    {
+        if (debug_vram_dirty[block & 0x7FF])
+            return true;
+    }
+
+    return false;
+}
+
+static void debug_mark_rows(int* dirty, int first, int last)
+{
+    dirty[0] = std::min(dirty[0], first);
+    dirty[1] = std::max(dirty[1], last);
+}
+
+static void update_debug_background_buffer_smsgg(bool full)
+{
+    Video* video = gearsystem->GetVideo();
+    u8* regs = video->GetRegisters();
+    u8* vram = video->GetVRAM();
+
+    int name_table_addr = (regs[2] & (video->IsExtendedMode224() ? 0x0C : 0x0E)) << 10;
+    if (video->IsExtendedMode224())
+        name_table_addr |= 0x700;
+
+    for (int tile_y = 0; tile_y < 32; tile_y++)
+    {
+        for (int tile_x = 0; tile_x < 32; tile_x++)
+        {
             u16 map_addr = name_table_addr + (64 * tile_y) + (tile_x * 2);
 
             u16 tile_info_lo = vram[map_addr];
             u16 tile_info_hi = vram[map_addr + 1];
 
             int tile_number = ((tile_info_hi & 1) << 8) | tile_info_lo;
+
+            if (!full && !debug_vram_range_dirty(map_addr, 2) && !debug_vram_range_dirty(tile_number * 32, 32))
+                continue;
+
             bool tile_hflip = IsSetBit((u8)tile_info_hi, 1);
             bool tile_vflip = IsSetBit((u8)tile_info_hi, 2);
             int tile_palette = IsSetBit((u8)tile_info_hi, 3) ? 16 : 0;
-            int final_offset_y = offset_y;
-            if (!tile_hflip)
-                offset_x = 7 - offset_x;
-            if (tile_vflip)
-                final_offset_y = 7 - offset_y;
 
-            int tile_data_addr = (tile_number * 32) + (4 * final_offset_y);
-            int color_index = ((vram[tile_data_addr] >> offset_x) & 1) | (((vram[tile_data_addr + 1] >> offset_x) & 1) << 1) | (((vram[tile_data_addr + 2] >> offset_x) & 1) << 2) | (((vram[tile_data_addr + 3] >> offset_x) & 1) << 3);
+            for (int offset_y = 0; offset_y < 8; offset_y++)
+            {
+                int final_offset_y = tile_vflip ? (7 - offset_y) : offset_y;
+                int tile_data_addr = (tile_number * 32) + (4 * final_offset_y);
+                int pixel = (((tile_y * 8) + offset_y) * 256) + (tile_x * 8);
+
+                for (int x = 0; x < 8; x++)
+                {
+                    int offset_x = tile_hflip ? x : (7 - x);
+                    int color_index = ((vram[tile_data_addr] >> offset_x) & 1) | (((vram[tile_data_addr + 1] >> offset_x) & 1) << 1) | (((vram[tile_data_addr + 2] >> offset_x) & 1) << 2) | (((vram[tile_data_addr + 3] >> offset_x) & 1) << 3);
+
+                    emu_debug_background_buffer[pixel + x] = video->ConvertTo8BitColor(color_index + tile_palette);
+                }
+            }
 
-            emu_debug_background_buffer[pixel] = video->ConvertTo8BitColor(color_index + tile_palette);
+            debug_mark_rows(emu_debug_background_dirty, tile_y * 8, (tile_y * 8) + 7);
         }
     }
 }
 
-static void update_debug_background_buffer_sg1000(void)
+static void update_debug_background_buffer_sg1000(bool full)
 {
     Video* video = gearsystem->GetVideo();
     u8* vram = video->GetVRAM();
@@ -494,18 +996,10 @@ static void update_debug_background_buffer_sg1000(void)
         color_table_addr = regs[3] << 6;
     }
 
-    for (int y = 0; y < 256; y++)
+    for (int tile_y = 0; tile_y < 32; tile_y++)
     {
-        int width_y = (y * 256);
-        int tile_y = y / 8;
-        int offset_y = y & 0x7;
-
-        for (int x = 0; x < 256; x++)
+        for (int tile_x = 0; tile_x < 32; tile_x++)
         {
-            int tile_x = x / 8;
-            int offset_x = 7 - (x & 0x7);
-            int pixel = width_y + x;
-
             int tile_number = (tile_y * 32) + tile_x;
 
             int name_tile_addr = name_table_addr + tile_number;
@@ -517,53 +1011,73 @@ static void update_debug_background_buffer_sg1000(void)
             else
                 name_tile = vram[name_tile_addr];
 
-            u8 pattern_line = vram[pattern_table_addr + (name_tile << 3) + offset_y];
+            int pattern_addr = pattern_table_addr + (name_tile << 3);
+            int color_addr = color_table_addr + ((mode == 0x200) ? (name_tile << 3) : (name_tile >> 3));
 
-            u8 color_line = 0;
+            if (!full && !debug_vram_range_dirty(name_tile_addr, 1) && !debug_vram_range_dirty(pattern_addr, 8) && !debug_vram_range_dirty(color_addr, (mode == 0x200) ? 8 : 1))
+                continue;
 
-            if (mode == 0x200)
-                color_line = vram[color_table_addr + (name_tile << 3) + offset_y];
-            else
-                color_line = vram[color_table_addr + (name_tile >> 3)];
+            for (int offset_y = 0; offset_y < 8; offset_y++)
+            {
+                u8 pattern_line = vram[pattern_addr + offset_y];
+
+                u8 color_line = 0;
+
+                if (mode == 0x200)
+                    color_line = vram[color_addr + offset_y];
+                else
+                    color_line = vram[color_addr];
 
-            int bg_color = color_line & 0x0F;
-            int fg_color = color_line >> 4;
-            int final_color = IsSetBit(pattern_line, offset_x) ? fg_color : bg_color;
+                int bg_color = color_line & 0x0F;
+                int fg_color = color_line >> 4;
+                int pixel = (((tile_y * 8) + offset_y) * 256) + (tile_x * 8);
+
+                for (int x = 0; x < 8; x++)
+                {
+                    int final_color = IsSetBit(pattern_line, 7 - x) ? fg_color : bg_color;
+
+                    emu_debug_background_buffer[pixel + x] = pal[(final_color > 0) ? final_color : backdrop_color];
+                }
+            }
 
-            emu_debug_background_buffer[pixel] = pal[(final_color > 0) ? final_color : backdrop_color];
+            debug_mark_rows(emu_debug_background_dirty, tile_y * 8, (tile_y * 8) + 7);
         }
     }
 }
 
-static void update_debug_tile_buffer_smsgg(void)
+static void update_debug_tile_buffer_smsgg(bool full)
 {
     Video* video = gearsystem->GetVideo();
     u8* vram = video->GetVRAM();
+    int tile_palette = emu_debug_tile_palette * 16;
 
-    for (int y = 0; y < 128; y++)
+    for (int tile_number = 0; tile_number < 512; tile_number++)
     {
-        int width_y = (y * 256);
-        int tile_y = y / 8;
-        int offset_y = y & 0x7;
+        if (!full && !debug_vram_range_dirty(tile_number * 32, 32))
+            continue;
 
-        for (int x = 0; x < 256; x++)
-        {
-            int tile_x = x / 8;
-            int offset_x = 7 - (x & 0x7);
-            int pixel = width_y + x;
-
-            int tile_number = (tile_y * 32) + tile_x;
-            int tile_palette = emu_debug_tile_palette * 16;
+        int tile_y = tile_number / 32;
+        int tile_x = tile_number % 32;
 
+        for (int offset_y = 0; offset_y < 8; offset_y++)
+        {
             int tile_data_addr = (tile_number * 32) + (4 * offset_y);
-            int color_index = ((vram[tile_data_addr] >> offset_x) & 1) | (((vram[tile_data_addr + 1] >> offset_x) & 1) << 1) | (((vram[tile_data_addr + 2] >> offset_x) & 1) << 2) | (((vram[tile_data_addr + 3] >> offset_x) & 1) << 3);
+            int pixel = (((tile_y * 8) + offset_y) * 256) + (tile_x * 8);
 
-            emu_debug_tile_buffer[pixel] = video->ConvertTo8BitColor(color_index + tile_palette);
+            for (int x = 0; x < 8; x++)
+            {
+                int offset_x = 7 - x;
+                int color_index = ((vram[tile_data_addr] >> offset_x) & 1) | (((vram[tile_data_addr + 1] >> offset_x) & 1) << 1) | (((vram[tile_data_addr + 2] >> offset_x) & 1) << 2) | (((vram[tile_data_addr + 3] >> offset_x) & 1) << 3);
+
+                emu_debug_tile_buffer[pixel + x] = video->ConvertTo8BitColor(color_index + tile_palette);
+            }
         }
+
+        debug_mark_rows(emu_debug_tile_dirty, tile_y * 8, (tile_y * 8) + 7);
     }
 }
 
-static void update_debug_tile_buffer_sg1000(void)
+static void update_debug_tile_buffer_sg1000(bool full)
 {
     Video* video = gearsystem->GetVideo();
     u8* vram = video->GetVRAM();
@@ -571,47 +1085,46 @@ static void update_debug_tile_buffer_sg1000(void)
     int mode = video->GetSG1000Mode();
 
     int pattern_table_addr = (regs[4] & ((mode == 0x200) ? 0x04 : 0x07)) << 11;
-    
-    for (int y = 0; y < 256; y++)
-    {
-        int width_y = (y * 256);
-        int tile_y = y / 8;
-        int offset_y = y & 0x7;
 
-        for (int x = 0; x < 256; x++)
-        {
-            int tile_x = x / 8;
-            int offset_x = 7 - (x & 0x7);
-            int pixel = width_y + x;
+    GS_Color black;
+    black.red = 0;
+    black.green = 0;
+    black.blue = 0;
 
-            int tile_number = (tile_y * 32) + tile_x;
+    GS_Color white;
+    white.red = 255;
+    white.green = 255;
+    white.blue = 255;
 
-            int tile_data_addr = pattern_table_addr + (tile_number * 8) + (1 * offset_y);
-            bool color = IsSetBit(vram[tile_data_addr], offset_x);
+    for (int tile_number = 0; tile_number < 1024; tile_number++)
+    {
+        int tile_data_addr = (pattern_table_addr + (tile_number * 8)) & 0x3FFF;
+
+        if (!full && !debug_vram_range_dirty(tile_data_addr, 8))
+            continue;
 
-            GS_Color black;
-            black.red = 0;
-            black.green = 0;
-            black.blue = 0;
+        int tile_y = tile_number / 32;
+        int tile_x = tile_number % 32;
 
-            GS_Color white;
-            black.red = 255;
-            black.green = 255;
-            black.blue = 255;
+        for (int offset_y = 0; offset_y < 8; offset_y++)
+        {
+            u8 line = vram[tile_data_addr + offset_y];
+            int pixel = (((tile_y * 8) + offset_y) * 256) + (tile_x * 8);
 
-            emu_debug_tile_buffer[pixel] = color ? white : black;
+            for (int x = 0; x < 8; x++)
+                emu_debug_tile_buffer[pixel + x] = IsSetBit(line, 7 - x) ? white : black;
         }
+
+        debug_mark_rows(emu_debug_tile_dirty, tile_y * 8, (tile_y * 8) + 7);
     }
 }
 
-static void update_debug_sprite_buffers_smsgg(void)
+static void update_debug_sprite_buffers_smsgg(bool full)
 {
     GearsystemCore* core = emu_get_core();
     Video* video = core->GetVideo();
     u8* regs = video->GetRegisters();
     u8* vram = video->GetVRAM();
-    GS_RuntimeInfo runtime;
-    emu_get_runtime(runtime);
 
     bool sprites_16 = IsSetBit(regs[1], 1);
     u16 sprite_table_address = (regs[5] << 7) & 0x3F00;
@@ -625,6 +1138,9 @@ static void update_debug_sprite_buffers_smsgg(void)
         tile &= sprites_16 ? 0xFE : 0xFF;
         int tile_addr = sprite_tiles_address + (tile << 5);
 
+        if (!full && !debug_vram_range_dirty(sprite_info_address + 1, 1) && !debug_vram_range_dirty(tile_addr, 64))
+            continue;
+
         int padding = 0;
         for (int pixel = 0; pixel < (8 * 16); pixel++)
         {
@@ -640,18 +1156,18 @@ static void update_debug_sprite_buffers_smsgg(void)
 
             emu_debug_sprite_buffers[s][pixel + padding] = video->ConvertTo8BitColor(color_index + 16);
         }
+
+        emu_debug_sprite_dirty[s] = true;
     }
 }
 
-static void update_debug_sprite_buffers_sg1000(void)
+static void update_debug_sprite_buffers_sg1000(bool full)
 {
     GearsystemCore* core = emu_get_core();
     Video* video = core->GetVideo();
     u8* regs = video->GetRegisters();
     u8* vram = video->GetVRAM();
     GS_Color* pal = video->GetSG1000Palette();
-    GS_RuntimeInfo runtime;
-    emu_get_runtime(runtime);
 
     int sprite_size = IsSetBit(regs[1], 1) ? 16 : 8;
     u16 sprite_attribute_addr = (regs[5] & 0x7F) << 7;
@@ -663,10 +1179,14 @@ static void update_debug_sprite_buffers_sg1000(void)
         int sprite_color = vram[sprite_attribute_offset + 3] & 0x0F;
         int sprite_tile = vram[sprite_attribute_offset + 2];
         sprite_tile &= (sprite_size == 16) ? 0xFC : 0xFF;
+        int sprite_tile_addr = sprite_pattern_addr + (sprite_tile << 3);
+
+        if (!full && !debug_vram_range_dirty(sprite_attribute_offset + 2, 2) && !debug_vram_range_dirty(sprite_tile_addr, (sprite_size == 16) ? 32 : 8))
+            continue;
 
         for (int pixel_y = 0; pixel_y < sprite_size; pixel_y++)
         {
-            int sprite_line_addr = sprite_pattern_addr + (sprite_tile << 3) + pixel_y;
+            int sprite_line_addr = sprite_tile_addr + pixel_y;
 
             for (int pixel_x = 0; pixel_x < 16; pixel_x++)
             {
@@ -685,5 +1205,7 @@ static void update_debug_sprite_buffers_sg1000(void)
                 emu_debug_sprite_buffers[s][pixel] = pal[sprite_pixel ? sprite_color : 0];
             }
         }
+
+        emu_debug_sprite_dirty[s] = true;
     }
 }
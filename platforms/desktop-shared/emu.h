@@ -32,24 +32,44 @@ EXTERN GS_Color* emu_frame_buffer;
 EXTERN GS_Color* emu_debug_background_buffer;
 EXTERN GS_Color* emu_debug_tile_buffer;
 EXTERN GS_Color* emu_debug_sprite_buffers[64];
+// First and last rows rebuilt since the last upload, first > last when clean
+EXTERN int emu_debug_background_dirty[2];
+EXTERN int emu_debug_tile_dirty[2];
+EXTERN bool emu_debug_sprite_dirty[64];
 
 EXTERN bool emu_audio_sync;
+// Minimum time per emulated frame in ms, 0 runs unthrottled
+EXTERN float emu_frame_time;
+// Each emu_update() starts one emulated frame and waits for it, so the
+// frame begins when the GUI has just read input instead of on its own clock
+EXTERN bool emu_frame_lock;
 EXTERN bool emu_debug_disable_breakpoints;
 EXTERN int emu_debug_tile_palette;
 
 EXTERN void emu_init(const char* save_path);
 EXTERN void emu_destroy(void);
 EXTERN void emu_update(void);
-EXTERN void emu_load_rom(const char* file_path, bool save_in_rom_dir, Cartridge::ForceConfiguration config);
+// Parks the emulation thread so the GUI can touch the core directly.
+// While the debugger is enabled frames run on the GUI thread instead.
+EXTERN void emu_sync_begin(void);
+EXTERN void emu_sync_end(void);
+// zip_entry picks a ROM inside a multi-ROM archive, -1 loads the first one
+EXTERN void emu_load_rom(const char* file_path, int zip_entry, bool save_in_rom_dir, Cartridge::ForceConfiguration config);
 EXTERN void emu_key_pressed(GS_Joypads pad, GS_Keys key);
 EXTERN void emu_key_released(GS_Joypads pad, GS_Keys key);
 EXTERN void emu_pause(void);
 EXTERN void emu_resume(void);
+// These read a snapshot taken at the last emu_sync_end(), safe without the lock
 EXTERN bool emu_is_paused(void);
 EXTERN bool emu_is_empty(void);
 EXTERN void emu_reset(bool save_in_rom_dir, Cartridge::ForceConfiguration config);
 EXTERN void emu_memory_dump(void);
 EXTERN void emu_dissasemble_rom(void);
+EXTERN void emu_enable_trace(bool enable);
+EXTERN bool emu_is_trace_enabled(void);
+EXTERN const char* emu_get_file_name(void);
+EXTERN void emu_clear_frame_buffer(void);
+EXTERN void emu_save_trace(void);
 EXTERN void emu_audio_volume(float volume);
 EXTERN void emu_audio_reset(void);
 EXTERN bool emu_is_audio_enabled(void);
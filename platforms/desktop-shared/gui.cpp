@@ -29,6 +29,8 @@
 #include "license.h"
 #include "backers.h"
 #include "gui_debug.h"
+#include "library.h"
+#include "pacing.h"
 
 #define GUI_IMPORT
 #include "gui.h"
@@ -41,6 +43,7 @@ static int* configured_button;
 static ImVec4 custom_palette[4];
 static std::list<std::string> cheat_list;
 static bool shortcut_open_rom = false;
+static bool open_library_folder = false;
 static ImFont* default_font[4];
 
 static void main_menu(void);
@@ -51,6 +54,7 @@ static void file_dialog_save_ram(void);
 static void file_dialog_load_state(void);
 static void file_dialog_save_state(void);
 static void file_dialog_load_symbols(void);
+static void file_dialog_library_folder(void);
 static void keyboard_configuration_item(const char* text, SDL_Scancode* key, int player);
 static void gamepad_configuration_item(const char* text, int* button, int player);
 static void popup_modal_keyboard();
@@ -62,6 +66,7 @@ static void menu_pause(void);
 static void menu_ffwd(void);
 static void show_info(void);
 static void show_fps(void);
+static void show_library(void);
 static Cartridge::CartridgeTypes get_mapper(int index);
 static Cartridge::CartridgeZones get_zone(int index);
 static Cartridge::CartridgeSystem get_system(int index);
@@ -111,6 +116,9 @@ void gui_render(void)
 
     gui_debug_windows();
 
+    if (config_emulator.show_library)
+        show_library();
+
     ImGui::Render();
 }
 
@@ -162,7 +170,22 @@ void gui_shortcut(gui_ShortCutEvent event)
     }
 }
 
-void gui_load_rom(const char* path)
+// Game Genie codes are 7 or 11 characters, Pro Action Replay ones are 9
+bool gui_add_cheat(const char* cheat)
+{
+    std::string code = cheat;
+
+    if ((cheat_list.size() < 10) && ((code.length() == 7) || (code.length() == 9) || (code.length() == 11)))
+    {
+        cheat_list.push_back(code);
+        emu_add_cheat(cheat);
+        return true;
+    }
+
+    return false;
+}
+
+void gui_load_rom(const char* path, int zip_entry)
 {
     Cartridge::ForceConfiguration config;
 
@@ -171,8 +194,11 @@ void gui_load_rom(const char* path)
     config.type = get_mapper(config_emulator.mapper);
     config.zone = get_zone(config_emulator.zone);
 
+    // The emulation thread must not run a frame between the load and the pause
+    emu_sync_begin();
+
     emu_resume();
-    emu_load_rom(path, config_emulator.save_in_rom_folder, config);
+    emu_load_rom(path, zip_entry, config_emulator.save_in_rom_folder, config);
     cheat_list.clear();
     emu_clear_cheats();
 
@@ -186,14 +212,10 @@ void gui_load_rom(const char* path)
     if (config_emulator.start_paused)
     {
         emu_pause();
-        
-        for (int i=0; i < (GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT); i++)
-        {
-            emu_frame_buffer[i].red = 0;
-            emu_frame_buffer[i].green = 0;
-            emu_frame_buffer[i].blue = 0;
-        }
+        emu_clear_frame_buffer();
     }
+
+    emu_sync_end();
 }
 
 static void main_menu(void)
@@ -225,7 +247,7 @@ static void main_menu(void)
                     {
                         if (ImGui::MenuItem(config_emulator.recent_roms[i].c_str()))
                         {
-                            gui_load_rom(config_emulator.recent_roms[i].c_str());
+                            gui_load_rom(config_emulator.recent_roms[i].c_str(), -1);
                         }
                     }
                 }
@@ -233,6 +255,8 @@ static void main_menu(void)
                 ImGui::EndMenu();
             }
 
+            ImGui::MenuItem("ROM Library...", "", &config_emulator.show_library);
+
             ImGui::Separator();
             
             if (ImGui::MenuItem("Reset", "Ctrl+R"))
@@ -381,14 +405,8 @@ static void main_menu(void)
 
                 if (ImGui::Button("Add Cheat Code"))
                 {
-                    std::string cheat = cheat_buffer;
-
-                    if ((cheat_list.size() < 10) && ((cheat.length() == 7) || (cheat.length() == 8) || (cheat.length() == 11)))
-                    {
-                        cheat_list.push_back(cheat_buffer);
-                        emu_add_cheat(cheat_buffer);
+                    if (gui_add_cheat(cheat_buffer))
                         cheat_buffer[0] = 0;
-                    }
                 }
 
                 std::list<std::string>::iterator it;
@@ -449,6 +467,8 @@ static void main_menu(void)
                 }
             }
 
+            ImGui::MenuItem("Frame Delay Auto-Tune", "", &config_video.frame_delay, config_video.sync);
+
             ImGui::MenuItem("Show FPS", "", &config_video.fps);
 
             ImGui::Separator();
@@ -669,6 +689,26 @@ static void main_menu(void)
 
             ImGui::MenuItem("Show VRAM Viewer", "", &config_debug.show_video, config_debug.debug);
 
+            ImGui::MenuItem("Show Profiler", "", &config_debug.show_profiler, config_debug.debug);
+
+            ImGui::MenuItem("Show VDP Timeline", "", &config_debug.show_vdp_timeline, config_debug.debug);
+
+            ImGui::MenuItem("Show Frame Stats", "", &config_debug.show_frame_stats, config_debug.debug);
+
+            ImGui::Separator();
+
+            bool trace = emu_is_trace_enabled();
+
+            if (ImGui::MenuItem("Trace Logger", "", &trace, config_debug.debug))
+            {
+                emu_enable_trace(trace);
+            }
+
+            if (ImGui::MenuItem("Save Trace", "", (void*)0, config_debug.debug && trace))
+            {
+                emu_save_trace();
+            }
+
             ImGui::Separator();
 
             if (ImGui::MenuItem("Load Symbols...", "", (void*)0, config_debug.debug))
@@ -721,6 +761,12 @@ static void main_menu(void)
     if (open_symbols)
         ImGui::OpenPopup("Load Symbols File...");
 
+    if (open_library_folder)
+    {
+        open_library_folder = false;
+        ImGui::OpenPopup("Select Library Folder...");
+    }
+
     if (open_about)
     {
         dialog_in_use = true;
@@ -734,6 +780,7 @@ static void main_menu(void)
     file_dialog_load_state();
     file_dialog_save_state();
     file_dialog_load_symbols();
+    file_dialog_library_folder();
 }
 
 static void main_window(void)
@@ -840,7 +887,7 @@ static void file_dialog_open_rom(void)
     if(file_dialog.showFileDialog("Open ROM...", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, ImVec2(700, 400), "*.*,.sms,.gg,.sg,.mv,.rom,.bin,.zip", &dialog_in_use))
     {
         push_recent_rom(file_dialog.selected_path.c_str());
-        gui_load_rom(file_dialog.selected_path.c_str());
+        gui_load_rom(file_dialog.selected_path.c_str(), -1);
     }
 }
 
@@ -906,6 +953,15 @@ static void file_dialog_load_symbols(void)
     }
 }
 
+static void file_dialog_library_folder(void)
+{
+    if(file_dialog.showFileDialog("Select Library Folder...", imgui_addons::ImGuiFileBrowser::DialogMode::SELECT, ImVec2(700, 400), "*.*", &dialog_in_use))
+    {
+        config_emulator.library_path = file_dialog.selected_path;
+        library_scan(config_emulator.library_path.c_str(), config_emulator.library_recursive);
+    }
+}
+
 static void keyboard_configuration_item(const char* text, SDL_Scancode* key, int player)
 {
     ImGui::Text("%s", text);
@@ -1123,8 +1179,6 @@ static void push_recent_rom(std::string path)
 
 static void menu_reset(void)
 {
-    emu_resume();
-
     Cartridge::ForceConfiguration config;
 
     config.system = get_system(config_emulator.system);
@@ -1132,19 +1186,18 @@ static void menu_reset(void)
     config.type = get_mapper(config_emulator.mapper);
     config.zone = get_zone(config_emulator.zone);
 
+    emu_sync_begin();
+
+    emu_resume();
     emu_reset(config_emulator.save_in_rom_folder, config);
 
     if (config_emulator.start_paused)
     {
         emu_pause();
-        
-        for (int i=0; i < (GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT); i++)
-        {
-            emu_frame_buffer[i].red = 0;
-            emu_frame_buffer[i].green = 0;
-            emu_frame_buffer[i].blue = 0;
-        }
+        emu_clear_frame_buffer();
     }
+
+    emu_sync_end();
 }
 
 static void menu_pause(void)
@@ -1175,7 +1228,7 @@ static void show_info(void)
     else
         ImGui::SetCursorPos(ImVec2(5.0f, config_debug.debug ? 25.0f : 5.0f));
 
-    static char info[512];
+    static char info[1024];
 
     emu_get_info(info);
     ImGui::Text("%s", info);
@@ -1184,7 +1237,128 @@ static void show_info(void)
 static void show_fps(void)
 {
     ImGui::SetCursorPos(ImVec2(5.0f, config_debug.debug ? 25.0f : 5.0f ));
-    ImGui::Text("Frame Rate: %.2f FPS\nFrame Time: %.2f ms", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+    pacing_Stats stats;
+    pacing_get_stats(stats);
+
+    ImGui::Text("Frame Rate: %.2f FPS\nFrame Time: %.2f ms\nFrame Time Deviation: %.2f ms\nDisplay Rate: %.2f Hz\nFrame Delay: %.2f ms\nTexture Upload: %.3f ms", ImGui::GetIO().Framerate, stats.frame_time, stats.frame_time_deviation, stats.display_rate, stats.frame_delay, renderer_upload_time);
+}
+
+static void show_library(void)
+{
+    static std::vector<library_Entry> entries;
+    static unsigned int revision = 0;
+    static ImGuiTextFilter filter;
+    static std::vector<int> visible;
+
+    unsigned int current_revision = library_get_revision();
+
+    if (current_revision != revision)
+    {
+        library_get_entries(entries);
+        revision = current_revision;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(600, 400), ImGuiCond_FirstUseEver);
+    ImGui::Begin("ROM Library", &config_emulator.show_library);
+
+    bool scanning = library_is_scanning();
+
+    if (ImGui::Button("Folder..."))
+        open_library_folder = true;
+
+    ImGui::SameLine();
+
+    if (scanning)
+    {
+        if (ImGui::Button("Cancel"))
+            library_cancel();
+    }
+    else if (ImGui::Button("Rescan") && (config_emulator.library_path.length() > 0))
+    {
+        library_scan(config_emulator.library_path.c_str(), config_emulator.library_recursive);
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Subfolders", &config_emulator.library_recursive);
+
+    ImGui::SameLine();
+    ImGui::TextDisabled("%s", config_emulator.library_path.c_str());
+
+    if (scanning)
+    {
+        int done, total;
+        library_get_progress(done, total);
+        char overlay[32];
+        snprintf(overlay, 32, "%d / %d", done, total);
+        ImGui::ProgressBar(total > 0 ? (float)done / (float)total : 0.0f, ImVec2(-1.0f, 0.0f), overlay);
+    }
+
+    filter.Draw("Filter", 200.0f);
+    ImGui::SameLine();
+    ImGui::Text("%d ROMs", (int)entries.size());
+
+    visible.clear();
+
+    for (int i = 0; i < (int)entries.size(); i++)
+    {
+        if (filter.PassFilter(entries[i].title.c_str()) || filter.PassFilter(entries[i].path.c_str()))
+            visible.push_back(i);
+    }
+
+    ImGui::Separator();
+    ImGui::BeginChild("##library_list");
+
+    ImGui::Columns(4, "##library_columns");
+    ImGui::Text("Title"); ImGui::NextColumn();
+    ImGui::Text("System"); ImGui::NextColumn();
+    ImGui::Text("Region"); ImGui::NextColumn();
+    ImGui::Text("CRC"); ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGuiListClipper clipper((int)visible.size());
+
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            const library_Entry& entry = entries[visible[row]];
+
+            ImGui::PushID(visible[row]);
+
+            if (ImGui::Selectable(entry.title.c_str(), false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick) && ImGui::IsMouseDoubleClicked(0))
+            {
+                // Recent ROMs hold paths only, they can not reopen one ROM out of an archive
+                if (entry.zip_entry < 0)
+                    push_recent_rom(entry.path);
+                gui_load_rom(entry.path.c_str(), entry.zip_entry);
+            }
+
+            if (ImGui::IsItemHovered())
+            {
+                if (entry.zip_entry < 0)
+                    ImGui::SetTooltip("%s", entry.path.c_str());
+                else
+                    ImGui::SetTooltip("%s (ROM %d)", entry.path.c_str(), entry.zip_entry + 1);
+            }
+
+            ImGui::NextColumn();
+
+            const char* system = "-";
+            if (entry.valid)
+                system = (entry.system == Cartridge::CartridgeGG) ? "Game Gear" : ((entry.system == Cartridge::CartridgeSG1000) ? "SG-1000" : "Master System");
+
+            ImGui::Text("%s", system); ImGui::NextColumn();
+            ImGui::Text("%s", entry.valid ? (entry.pal ? "PAL" : "NTSC") : "-"); ImGui::NextColumn();
+            ImGui::Text("%08X", entry.crc); ImGui::NextColumn();
+
+            ImGui::PopID();
+        }
+    }
+
+    ImGui::Columns(1);
+    ImGui::EndChild();
+
+    ImGui::End();
 }
 
 static Cartridge::CartridgeTypes get_mapper(int index)
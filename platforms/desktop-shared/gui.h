@@ -63,7 +63,8 @@ EXTERN void gui_init(void);
 EXTERN void gui_destroy(void);
 EXTERN void gui_render(void);
 EXTERN void gui_shortcut(gui_ShortCutEvent event);
-EXTERN void gui_load_rom(const char* path);
+EXTERN void gui_load_rom(const char* path, int zip_entry);
+EXTERN bool gui_add_cheat(const char* cheat);
 
 #undef GUI_IMPORT
 #undef EXTERN
@@ -17,6 +17,7 @@
  *
  */
 
+#include <unordered_map>
 #include "imgui/imgui.h"
 #include "imgui/imgui_memory_editor.h"
 #include "FileBrowser/ImGuiFileBrowser.h"
@@ -40,11 +41,22 @@ struct DebugSymbol
 struct DisassmeblerLine
 {
     bool is_symbol;
-    bool is_breakpoint;
+    u16 address;
     Memory::stDisassembleRecord* record;
-    std::string symbol;
+    const std::string* symbol;
+};
+
+struct DisassemblerCache
+{
+    int banks[3];
+    u32 disassembly_revision;
+    unsigned int symbols_revision;
+    bool show_symbols;
+    std::vector<DisassmeblerLine> lines;
 };
 
+typedef std::unordered_map<u64, std::vector<std::string> > DebugSymbolMap;
+
 static MemoryEditor mem_edit;
 static ImVec4 cyan = ImVec4(0.0f,1.0f,1.0f,1.0f);
 static ImVec4 magenta = ImVec4(1.0f,0.502f,0.957f,1.0f);
@@ -54,12 +66,21 @@ static ImVec4 green = ImVec4(0.0f,1.0f,0.0f,1.0f);
 static ImVec4 white = ImVec4(1.0f,1.0f,1.0f,1.0f);
 static ImVec4 gray = ImVec4(0.5f,0.5f,0.5f,1.0f);
 static ImVec4 dark_gray = ImVec4(0.1f,0.1f,0.1f,1.0f);
-static std::vector<DebugSymbol> symbols;
+static DebugSymbolMap symbols;
+static unsigned int symbols_revision = 0;
+static DisassemblerCache disassembler_cache;
 static Memory::stDisassembleRecord* selected_record = NULL;
 static char brk_address[8] = "";
+static char watch_range[12] = "";
+static char watch_condition[64] = "";
+static int watch_space = 0;
+static bool watch_read = false;
+static bool watch_write = true;
+static std::string watch_error;
 
 static void debug_window_processor(void);
 static void debug_window_memory(void);
+static void debug_memory_search(void);
 static void debug_window_disassembler(void);
 static void debug_window_vram(void);
 static void debug_window_vram_background(void);
@@ -67,8 +88,17 @@ static void debug_window_vram_tiles(void);
 static void debug_window_vram_sprites(void);
 static void debug_window_vram_palettes(void);
 static void debug_window_vram_regs(void);
+static void debug_window_profiler(void);
+static void debug_window_vdp_timeline(void);
+static void debug_window_frame_stats(void);
+static void vdp_timeline_event_text(const Video::TimelineEvent& event, char* text, int size);
 static void add_symbol(const char* line);
+static u64 symbol_key(int bank, int address);
 static void add_breakpoint(void);
+static void add_watchpoint(void);
+static void debug_watchpoints(void);
+static void update_disassembler_cache(Memory* memory, bool show_symbols);
+static int find_disassembler_line(u16 address);
 static ImVec4 color_444_to_float(u16 color);
 static ImVec4 color_222_to_float(u8 color);
 
@@ -84,6 +114,12 @@ void gui_debug_windows(void)
             debug_window_disassembler();
         if (config_debug.show_video)
             debug_window_vram();
+        if (config_debug.show_profiler)
+            debug_window_profiler();
+        if (config_debug.show_vdp_timeline)
+            debug_window_vdp_timeline();
+        if (config_debug.show_frame_stats)
+            debug_window_frame_stats();
     }
 }
 
@@ -97,6 +133,8 @@ void gui_debug_reset(void)
 void gui_debug_reset_symbols(void)
 {
     symbols.clear();
+    symbols_revision++;
+    emu_get_core()->GetProfiler()->ClearSymbols();
     
     for (int i = 0; i < gui_debug_symbols_count; i++)
         add_symbol(gui_debug_symbols[i]);
@@ -125,23 +163,12 @@ void gui_debug_toggle_breakpoint(void)
 {
     if (IsValidPointer(selected_record))
     {
-        bool found = false;
-        std::vector<Memory::stDisassembleRecord*>* breakpoints = emu_get_core()->GetMemory()->GetBreakpoints();
+        Memory* memory = emu_get_core()->GetMemory();
 
-        for (long unsigned int b = 0; b < breakpoints->size(); b++)
-        {
-            if ((*breakpoints)[b] == selected_record)
-            {
-                found = true;
-                 InitPointer((*breakpoints)[b]);
-                break;
-            }
-        }
-
-        if (!found)
-        {
-            breakpoints->push_back(selected_record);
-        }
+        if (memory->IsBreakpoint(selected_record))
+            memory->RemoveBreakpoint(selected_record);
+        else
+            memory->AddBreakpoint(selected_record);
     }
 }
 
@@ -156,7 +183,7 @@ void gui_debug_runtocursor(void)
 
 void gui_debug_reset_breakpoints(void)
 {
-    emu_get_core()->GetMemory()->GetBreakpoints()->clear();
+    emu_get_core()->GetMemory()->ResetBreakpoints();
     brk_address[0] = 0;
 }
 
@@ -278,12 +305,140 @@ static void debug_window_memory(void)
             ImGui::EndTabItem();
         }
 
+        if (ImGui::BeginTabItem("SEARCH"))
+        {
+            debug_memory_search();
+            ImGui::EndTabItem();
+        }
+
         ImGui::EndTabBar();
     }
 
     ImGui::End();
 }
 
+static void debug_memory_search(void)
+{
+    CheatSearch* search = emu_get_core()->GetCheatSearch();
+
+    static std::vector<int> candidates;
+    static int relation = 0;
+    static int operand = 0;
+    static int frames = 1;
+    static char value_buffer[3] = "00";
+    static char cheat_buffer[3] = "00";
+    static bool filter_failed = false;
+
+    if (ImGui::Button(search->IsActive() ? "Restart" : "Start"))
+    {
+        search->Start();
+        search->GetCandidates(candidates);
+        filter_failed = false;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Stop"))
+    {
+        search->Stop();
+        candidates.clear();
+        filter_failed = false;
+    }
+
+    if (!search->IsActive())
+    {
+        ImGui::TextColored(gray, "Start a search to snapshot work RAM and cartridge RAM every frame");
+        return;
+    }
+
+    ImGui::PushItemWidth(140);
+    ImGui::Combo("##search_relation", &relation, "Equal to\0Not equal to\0Greater than\0Less than\0Increased by\0Decreased by\0\0");
+    ImGui::SameLine();
+    ImGui::Combo("##search_operand", &operand, "Previous search\0Frames ago\0Value\0\0");
+    ImGui::PopItemWidth();
+
+    if (operand == CheatSearch::OperandFrames)
+    {
+        ImGui::SameLine();
+        ImGui::PushItemWidth(80);
+        ImGui::SliderInt("##search_frames", &frames, 1, GS_CHEAT_SEARCH_FRAMES - 1);
+        ImGui::PopItemWidth();
+    }
+
+    if ((operand == CheatSearch::OperandValue) || (relation >= CheatSearch::RelationIncreasedBy))
+    {
+        ImGui::SameLine();
+        ImGui::PushItemWidth(30);
+        ImGui::InputText("##search_value", value_buffer, IM_ARRAYSIZE(value_buffer), ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_CharsUppercase);
+        ImGui::PopItemWidth();
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Filter"))
+    {
+        int value = 0;
+        sscanf(value_buffer, "%x", &value);
+        filter_failed = (search->Filter((CheatSearch::Relation)relation, (CheatSearch::Operand)operand, (u8)value, frames) < 0);
+        search->GetCandidates(candidates);
+    }
+
+    if (filter_failed)
+        ImGui::TextColored(red, "Not enough frames captured to compare with %d frames ago, nothing was filtered", frames);
+
+    ImGui::PushFont(gui_default_font);
+
+    ImGui::TextColored(cyan, "CANDIDATES:"); ImGui::SameLine();
+    ImGui::Text("%d of %d", search->GetCandidateCount(), search->GetSize()); ImGui::SameLine();
+    ImGui::TextColored(cyan, "  PAR VALUE:"); ImGui::SameLine();
+    ImGui::PushItemWidth(30);
+    ImGui::InputText("##cheat_value", cheat_buffer, IM_ARRAYSIZE(cheat_buffer), ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_CharsUppercase);
+    ImGui::PopItemWidth();
+
+    ImGui::BeginChild("search_candidates", ImVec2(0, 0), false);
+    ImGui::Columns(4, "search_candidates", false);
+    ImGui::SetColumnOffset(1, 80);
+    ImGui::SetColumnOffset(2, 140);
+    ImGui::SetColumnOffset(3, 200);
+
+    ImGuiListClipper clipper((int)candidates.size(), ImGui::GetTextLineHeightWithSpacing());
+
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+        {
+            int offset = candidates[i];
+            int address = search->GetAddress(offset);
+
+            if (address >= 0)
+                ImGui::TextColored(cyan, "$%04X", address);
+            else
+                ImGui::TextColored(gray, "EXT %04X", offset - GS_CHEAT_SEARCH_WORK_RAM);
+            ImGui::NextColumn();
+
+            ImGui::Text("$%02X", search->GetValue(offset)); ImGui::NextColumn();
+            ImGui::TextColored(gray, "$%02X", search->GetPrevious(offset)); ImGui::NextColumn();
+
+            std::string code;
+            int value = 0;
+            sscanf(cheat_buffer, "%x", &value);
+
+            if (search->GetCheatCode(offset, (u8)value, code))
+            {
+                ImGui::PushID(i);
+                if (ImGui::SmallButton("PAR"))
+                    gui_add_cheat(code.c_str());
+                ImGui::PopID();
+                ImGui::SameLine();
+                ImGui::TextColored(gray, "%s", code.c_str());
+            }
+            ImGui::NextColumn();
+        }
+    }
+
+    ImGui::Columns(1);
+    ImGui::EndChild();
+
+    ImGui::PopFont();
+}
+
 static void debug_window_disassembler(void)
 {
     ImGui::SetNextWindowPos(ImVec2(160, 30), ImGuiCond_FirstUseEver);
@@ -296,9 +451,6 @@ static void debug_window_disassembler(void)
     Processor::ProcessorState* proc_state = processor->GetState();
     Memory* memory = core->GetMemory();
     std::vector<Memory::stDisassembleRecord*>* breakpoints = memory->GetBreakpoints();
-    Memory::stDisassembleRecord** memoryMap = memory->GetDisassembledMemoryMap();
-    Memory::stDisassembleRecord** romMap = memory->GetDisassembledROMMemoryMap();
-    Memory::stDisassembleRecord** map = NULL;
 
     int pc = proc_state->PC->GetValue();
 
@@ -357,15 +509,12 @@ static void debug_window_disassembler(void)
 
         for (long unsigned int b = 0; b < breakpoints->size(); b++)
         {
-            if (!IsValidPointer((*breakpoints)[b]))
-                continue;
-
             ImGui::PushID(b);
             if (ImGui::SmallButton("X"))
             {
-               InitPointer((*breakpoints)[b]);
+               memory->RemoveBreakpoint((*breakpoints)[b]);
                ImGui::PopID();
-               continue;
+               break;
             }
 
             ImGui::PopID();
@@ -383,75 +532,22 @@ static void debug_window_disassembler(void)
         ImGui::Separator();
     }
 
+    if (ImGui::CollapsingHeader("Watchpoints"))
+    {
+        debug_watchpoints();
+    }
+
     ImGui::PushFont(gui_default_font);
 
     bool window_visible = ImGui::BeginChild("##dis", ImVec2(ImGui::GetWindowContentRegionWidth(), 0), true, 0);
     
     if (window_visible)
     {
-        int dis_size = 0;
-        int pc_pos = 0;
-        
-        std::vector<DisassmeblerLine> vec(0x10000);
-        
-        for (int i = 0; i < 0x10000; i++)
-        {
-            int offset = i;
-            int bank = 0;
+        update_disassembler_cache(memory, show_symbols);
 
-            switch (i & 0xC000)
-            {
-            case 0x0000:
-                bank = memory->GetCurrentRule()->GetBank(0);
-                offset = (0x4000 * bank) + i;
-                map = romMap;
-                break;
-            case 0x4000:
-                bank = memory->GetCurrentRule()->GetBank(1);
-                offset = (0x4000 * bank) + (i & 0x3FFF);
-                map = romMap;
-                break;
-            case 0x8000:
-                bank = memory->GetCurrentRule()->GetBank(2);
-                offset = (0x4000 * bank) + (i & 0x3FFF);
-                map = romMap;
-                break;
-            default:
-                map = memoryMap;
-            }
-
-            if (IsValidPointer(map[offset]) && (map[offset]->name[0] != 0))
-            {
-                for (long unsigned int s = 0; s < symbols.size(); s++)
-                {
-                    if ((symbols[s].bank == bank) && (symbols[s].address == offset) && show_symbols)
-                    {
-                        vec[dis_size].is_symbol = true;
-                        vec[dis_size].symbol = symbols[s].text;
-                        dis_size ++;
-                    }
-                }
-
-                vec[dis_size].is_symbol = false;
-                vec[dis_size].record = map[offset];
-
-                if (vec[dis_size].record->address == pc)
-                    pc_pos = dis_size;
-
-                vec[dis_size].is_breakpoint = false;
-
-                for (long unsigned int b = 0; b < breakpoints->size(); b++)
-                {
-                    if ((*breakpoints)[b] == vec[dis_size].record)
-                    {
-                        vec[dis_size].is_breakpoint = true;
-                        break;
-                    }
-                }
-
-                dis_size++;
-            }
-        }
+        std::vector<DisassmeblerLine>& vec = disassembler_cache.lines;
+        int dis_size = (int)vec.size();
+        int pc_pos = find_disassembler_line(pc);
 
         if (follow_pc)
         {
@@ -468,7 +564,7 @@ static void debug_window_disassembler(void)
             {
                 if (vec[item].is_symbol)
                 {
-                    ImGui::TextColored(green, "%s:", vec[item].symbol.c_str());
+                    ImGui::TextColored(green, "%s:", vec[item].symbol->c_str());
                     continue;
                 }
 
@@ -490,7 +586,7 @@ static void debug_window_disassembler(void)
                 if (is_selected)
                     ImGui::SetItemDefaultFocus();
 
-                if (vec[item].is_breakpoint)
+                if (memory->IsBreakpoint(vec[item].record))
                 {
                     ImGui::SameLine();
                     if (vec[item].record->address == pc)
@@ -1299,6 +1395,453 @@ static void debug_window_vram_regs(void)
     ImGui::PopFont();
 }
 
+static void debug_window_profiler(void)
+{
+    ImGui::SetNextWindowPos(ImVec2(650, 30), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(420, 400), ImGuiCond_FirstUseEver);
+
+    ImGui::Begin("Profiler", &config_debug.show_profiler);
+
+    GearsystemCore* core = emu_get_core();
+    Profiler* profiler = core->GetProfiler();
+
+    static std::vector<Profiler::HotSpot> hot_spots;
+    static bool by_symbol = false;
+    static int refresh = 0;
+
+    bool enabled = profiler->IsEnabled();
+
+    if (ImGui::Checkbox("Enabled", &enabled))
+        profiler->Enable(enabled);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+        profiler->Clear();
+    ImGui::SameLine();
+    if (ImGui::Button("Save CSV"))
+    {
+        std::string path = std::string(core->GetCartridge()->GetFilePath()) + ".profile.csv";
+        profiler->SaveCSV(path.c_str());
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save Folded"))
+    {
+        std::string path = std::string(core->GetCartridge()->GetFilePath()) + ".profile.folded";
+        profiler->SaveFolded(path.c_str());
+    }
+
+    if (ImGui::RadioButton("By Address", !by_symbol))
+    {
+        by_symbol = false;
+        refresh = 0;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("By Symbol", by_symbol))
+    {
+        by_symbol = true;
+        refresh = 0;
+    }
+
+    // Sorting every counter is not free, the table updates twice per second
+    if (refresh <= 0)
+    {
+        if (by_symbol)
+            profiler->GetSymbolHotSpots(hot_spots);
+        else
+            profiler->GetHotSpots(hot_spots);
+
+        refresh = 30;
+    }
+    refresh--;
+
+    u64 total = profiler->GetTotalCycles();
+    double scale = (total > 0) ? (100.0 / (double)total) : 0.0;
+
+    ImGui::PushFont(gui_default_font);
+
+    ImGui::TextColored(magenta, "CYCLES:");ImGui::SameLine();
+    ImGui::Text("%llu", (unsigned long long)total);
+
+    ImGui::Columns(4, "profiler");
+    ImGui::SetColumnOffset(1, 85);
+    ImGui::SetColumnOffset(2, 185);
+    ImGui::SetColumnOffset(3, 250);
+    ImGui::Separator();
+    ImGui::TextColored(cyan, "ADDRESS"); ImGui::NextColumn();
+    ImGui::TextColored(cyan, "CYCLES"); ImGui::NextColumn();
+    ImGui::TextColored(cyan, "%%"); ImGui::NextColumn();
+    ImGui::TextColored(cyan, "SYMBOL"); ImGui::NextColumn();
+    ImGui::Separator();
+    ImGui::Columns(1);
+
+    ImGui::BeginChild("hot_spots", ImVec2(0, 0), false);
+    ImGui::Columns(4, "hot_spots", false);
+    ImGui::SetColumnOffset(1, 85);
+    ImGui::SetColumnOffset(2, 185);
+    ImGui::SetColumnOffset(3, 250);
+
+    ImGuiListClipper clipper((int)hot_spots.size(), ImGui::GetTextLineHeightWithSpacing());
+
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+        {
+            Profiler::HotSpot& spot = hot_spots[i];
+
+            if (spot.bank < 0)
+                ImGui::TextColored(gray, "--:----");
+            else
+                ImGui::TextColored(cyan, "%02X:%04X", spot.bank, spot.address);
+            ImGui::NextColumn();
+            ImGui::Text("%llu", (unsigned long long)spot.cycles);
+            ImGui::NextColumn();
+            ImGui::TextColored(yellow, "%6.2f", spot.cycles * scale);
+            ImGui::NextColumn();
+            ImGui::TextColored(green, "%s", spot.symbol.c_str());
+            ImGui::NextColumn();
+        }
+    }
+
+    ImGui::Columns(1);
+    ImGui::EndChild();
+
+    ImGui::PopFont();
+
+    ImGui::End();
+}
+
+static void debug_window_vdp_timeline(void)
+{
+    ImGui::SetNextWindowPos(ImVec2(650, 60), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(420, 560), ImGuiCond_FirstUseEver);
+
+    ImGui::Begin("VDP Timeline", &config_debug.show_vdp_timeline);
+
+    Video* video = emu_get_core()->GetVideo();
+    const ImVec4 event_colors[] = { yellow, cyan, red, gray, green, green };
+
+    bool enabled = video->IsTimelineEnabled();
+
+    if (ImGui::Checkbox("Record", &enabled))
+        video->EnableTimeline(enabled);
+
+    const Video::Timeline* timeline = video->GetTimeline();
+
+    if (!IsValidPointer(timeline) || (timeline->line_count == 0))
+    {
+        ImGui::TextColored(gray, "No complete frame recorded");
+        ImGui::End();
+        return;
+    }
+
+    int active_vram = 0, blank_vram = 0, active_cram = 0, blank_cram = 0;
+
+    for (int l = 0; l < timeline->line_count; l++)
+    {
+        if (l < timeline->active_lines)
+        {
+            active_vram += timeline->lines[l].vram_writes;
+            active_cram += timeline->lines[l].cram_writes;
+        }
+        else
+        {
+            blank_vram += timeline->lines[l].vram_writes;
+            blank_cram += timeline->lines[l].cram_writes;
+        }
+    }
+
+    ImGui::PushFont(gui_default_font);
+
+    ImGui::TextColored(magenta, "EVENTS:"); ImGui::SameLine();
+    ImGui::Text("%d", timeline->event_count); ImGui::SameLine();
+    if (timeline->dropped > 0)
+    {
+        ImGui::TextColored(red, "(%d dropped)", timeline->dropped); ImGui::SameLine();
+    }
+    ImGui::TextColored(magenta, " LINES:"); ImGui::SameLine();
+    ImGui::Text("%d", timeline->line_count);
+
+    ImGui::TextColored(magenta, "VRAM WRITES:"); ImGui::SameLine();
+    ImGui::TextColored((active_vram > 0) ? red : white, "%d active", active_vram); ImGui::SameLine();
+    ImGui::Text("%d blank", blank_vram);
+
+    ImGui::TextColored(magenta, "CRAM WRITES:"); ImGui::SameLine();
+    ImGui::TextColored((active_cram > 0) ? red : white, "%d active", active_cram); ImGui::SameLine();
+    ImGui::Text("%d blank", blank_cram);
+
+    // One row per line, cycles along x, write counts as bars on the right
+    float scale_x = 1.0f;
+    float scale_y = 1.0f;
+    float bars_x = (GS_CYCLES_PER_LINE * scale_x) + 8.0f;
+    float bars_w = 64.0f;
+    float height = timeline->line_count * scale_y;
+
+    ImVec2 p = ImGui::GetCursorScreenPos();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    draw_list->AddRectFilled(p, ImVec2(p.x + bars_x - 8.0f, p.y + (timeline->active_lines * scale_y)), ImColor(dark_gray));
+    draw_list->AddRect(ImVec2(p.x - 1.0f, p.y - 1.0f), ImVec2(p.x + bars_x - 7.0f, p.y + height + 1.0f), ImColor(gray));
+
+    for (int l = 0; l < timeline->line_count; l++)
+    {
+        const Video::TimelineLine& line = timeline->lines[l];
+        float y = p.y + (l * scale_y);
+        bool active = (l < timeline->active_lines);
+
+        if (line.vram_writes > 0)
+        {
+            float w = std::min((float)line.vram_writes, bars_w);
+            draw_list->AddRectFilled(ImVec2(p.x + bars_x, y), ImVec2(p.x + bars_x + w, y + scale_y), ImColor(active ? red : green));
+        }
+
+        if (line.cram_writes > 0)
+        {
+            float w = std::min((float)line.cram_writes * 4.0f, bars_w);
+            draw_list->AddRectFilled(ImVec2(p.x + bars_x + bars_w + 4.0f, y), ImVec2(p.x + bars_x + bars_w + 4.0f + w, y + scale_y), ImColor(magenta));
+        }
+    }
+
+    for (int i = 0; i < timeline->event_count; i++)
+    {
+        const Video::TimelineEvent& event = timeline->events[i];
+        float x = p.x + (event.cycle * scale_x);
+        float y = p.y + (event.line * scale_y);
+        draw_list->AddRectFilled(ImVec2(x, y), ImVec2(x + 3.0f, y + scale_y), ImColor(event_colors[event.type]));
+    }
+
+    ImGui::InvisibleButton("##timeline", ImVec2(bars_x + (bars_w * 2.0f) + 4.0f, height));
+
+    if (ImGui::IsItemHovered())
+    {
+        int l = (int)((ImGui::GetIO().MousePos.y - p.y) / scale_y);
+
+        if ((l >= 0) && (l < timeline->line_count))
+        {
+            const Video::TimelineLine& line = timeline->lines[l];
+            char text[64];
+
+            draw_list->AddLine(ImVec2(p.x, p.y + (l * scale_y)), ImVec2(p.x + bars_x - 8.0f, p.y + (l * scale_y)), ImColor(white));
+
+            ImGui::BeginTooltip();
+            ImGui::TextColored(cyan, "LINE %d", l); ImGui::SameLine();
+            ImGui::TextColored(gray, "%s", (l < timeline->active_lines) ? "active" : "blank");
+            ImGui::Text("VRAM W:%d R:%d  CRAM W:%d", line.vram_writes, line.vram_reads, line.cram_writes);
+
+            for (int i = 0; i < timeline->event_count; i++)
+            {
+                const Video::TimelineEvent& event = timeline->events[i];
+
+                if (event.line != l)
+                    continue;
+
+                vdp_timeline_event_text(event, text, sizeof(text));
+                ImGui::TextColored(event_colors[event.type], "%3d: %s", event.cycle, text);
+            }
+
+            ImGui::EndTooltip();
+        }
+    }
+
+    ImGui::Separator();
+
+    ImGui::BeginChild("vdp_events", ImVec2(0, 0), false);
+    ImGui::Columns(3, "vdp_events", false);
+    ImGui::SetColumnOffset(1, 50);
+    ImGui::SetColumnOffset(2, 100);
+
+    ImGuiListClipper clipper(timeline->event_count, ImGui::GetTextLineHeightWithSpacing());
+
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+        {
+            const Video::TimelineEvent& event = timeline->events[i];
+            char text[64];
+            vdp_timeline_event_text(event, text, sizeof(text));
+
+            ImGui::TextColored(cyan, "%3d", event.line);
+            ImGui::NextColumn();
+            ImGui::TextColored(gray, "%3d", event.cycle);
+            ImGui::NextColumn();
+            ImGui::TextColored(event_colors[event.type], "%s", text);
+            ImGui::NextColumn();
+        }
+    }
+
+    ImGui::Columns(1);
+    ImGui::EndChild();
+
+    ImGui::PopFont();
+
+    ImGui::End();
+}
+
+static void debug_window_frame_stats(void)
+{
+    ImGui::SetNextWindowPos(ImVec2(650, 90), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(560, 330), ImGuiCond_FirstUseEver);
+
+    ImGui::Begin("Frame Stats", &config_debug.show_frame_stats);
+
+    GearsystemCore* core = emu_get_core();
+    const ImVec4 colors[] = { green, yellow, magenta, gray };
+    const char* names[] = { "CODE", "I/O", "INTERRUPT", "HALT" };
+
+    bool enabled = core->IsFrameStatsEnabled();
+
+    if (ImGui::Checkbox("Enabled", &enabled))
+        core->EnableFrameStats(enabled);
+
+    int count = core->GetFrameStatsCount();
+
+    if (count == 0)
+    {
+        ImGui::TextColored(gray, "No complete frame recorded");
+        ImGui::End();
+        return;
+    }
+
+    const Processor::FrameStats* last = core->GetFrameStats(0);
+    u64 totals[4] = { };
+    u64 total = 0;
+    u32 max_cycles = 1;
+    u32 max_latency = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const Processor::FrameStats* stats = core->GetFrameStats(i);
+        totals[0] += stats->code_cycles;
+        totals[1] += stats->io_cycles;
+        totals[2] += stats->interrupt_cycles;
+        totals[3] += stats->halt_cycles;
+        total += stats->cycles;
+        max_cycles = std::max(max_cycles, stats->cycles);
+        max_latency = std::max(max_latency, stats->int_latency_max);
+    }
+
+    u32 last_cycles[4] = { last->code_cycles, last->io_cycles, last->interrupt_cycles, last->halt_cycles };
+    double last_scale = (last->cycles > 0) ? (100.0 / (double)last->cycles) : 0.0;
+    double avg_scale = (total > 0) ? (100.0 / (double)total) : 0.0;
+
+    ImGui::PushFont(gui_default_font);
+
+    ImGui::Columns(3, "frame_stats", false);
+    ImGui::SetColumnOffset(1, 100);
+    ImGui::SetColumnOffset(2, 260);
+
+    ImGui::TextColored(magenta, "CYCLES"); ImGui::NextColumn();
+    ImGui::TextColored(magenta, "LAST FRAME"); ImGui::NextColumn();
+    ImGui::TextColored(magenta, "AVG %d FRAMES", count); ImGui::NextColumn();
+
+    for (int i = 0; i < 4; i++)
+    {
+        ImGui::TextColored(colors[i], "%s", names[i]); ImGui::NextColumn();
+        ImGui::Text("%6u %5.1f%%", last_cycles[i], last_cycles[i] * last_scale); ImGui::NextColumn();
+        ImGui::Text("%5.1f%%", totals[i] * avg_scale); ImGui::NextColumn();
+    }
+
+    ImGui::Text("TOTAL"); ImGui::NextColumn();
+    ImGui::Text("%6u", last->cycles); ImGui::NextColumn();
+    ImGui::Text("%6llu", (unsigned long long)(total / count)); ImGui::NextColumn();
+
+    ImGui::Columns(1);
+
+    ImGui::TextColored(cyan, "INT:"); ImGui::SameLine();
+    ImGui::Text("%u", last->int_count); ImGui::SameLine();
+    ImGui::TextColored(cyan, " NMI:"); ImGui::SameLine();
+    ImGui::Text("%u", last->nmi_count); ImGui::SameLine();
+    ImGui::TextColored(cyan, " LATENCY MIN/AVG/MAX:"); ImGui::SameLine();
+    ImGui::Text("%u/%u/%u", last->int_latency_min, (last->int_count > 0) ? (last->int_latency_total / last->int_count) : 0, last->int_latency_max);
+
+    ImGui::PopFont();
+
+    ImGui::Separator();
+
+    // Oldest frame on the left, categories stacked bottom to top
+    float bar_w = 2.0f;
+    float height = 120.0f;
+    float width = GS_FRAME_STATS_HISTORY * bar_w;
+    float scale = height / (float)max_cycles;
+
+    ImVec2 p = ImGui::GetCursorScreenPos();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    draw_list->AddRectFilled(p, ImVec2(p.x + width, p.y + height), ImColor(dark_gray));
+
+    for (int i = 0; i < count; i++)
+    {
+        const Processor::FrameStats* stats = core->GetFrameStats(i);
+        u32 cycles[4] = { stats->code_cycles, stats->io_cycles, stats->interrupt_cycles, stats->halt_cycles };
+        float x = p.x + width - ((i + 1) * bar_w);
+        float y = p.y + height;
+
+        for (int c = 0; c < 4; c++)
+        {
+            float h = cycles[c] * scale;
+            draw_list->AddRectFilled(ImVec2(x, y - h), ImVec2(x + bar_w, y), ImColor(colors[c]));
+            y -= h;
+        }
+    }
+
+    ImGui::InvisibleButton("##frame_stats", ImVec2(width, height));
+
+    if (ImGui::IsItemHovered())
+    {
+        int age = (int)((p.x + width - ImGui::GetIO().MousePos.x) / bar_w);
+        const Processor::FrameStats* stats = core->GetFrameStats(age);
+
+        if (IsValidPointer(stats))
+        {
+            ImGui::BeginTooltip();
+            ImGui::TextColored(cyan, "FRAME -%d", age);
+            ImGui::TextColored(colors[0], "CODE: %u", stats->code_cycles);
+            ImGui::TextColored(colors[1], "I/O: %u", stats->io_cycles);
+            ImGui::TextColored(colors[2], "INTERRUPT: %u", stats->interrupt_cycles);
+            ImGui::TextColored(colors[3], "HALT: %u", stats->halt_cycles);
+            ImGui::Text("INT: %u  LATENCY: %u/%u", stats->int_count, stats->int_latency_min, stats->int_latency_max);
+            ImGui::EndTooltip();
+        }
+    }
+
+    float latency[GS_FRAME_STATS_HISTORY];
+
+    for (int i = 0; i < count; i++)
+        latency[count - 1 - i] = (float)core->GetFrameStats(i)->int_latency_max;
+
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "max INT latency %u", max_latency);
+    ImGui::PlotLines("##latency", latency, count, 0, overlay, 0.0f, (float)std::max(max_latency, 1u), ImVec2(width, 50.0f));
+
+    ImGui::End();
+}
+
+static void vdp_timeline_event_text(const Video::TimelineEvent& event, char* text, int size)
+{
+    switch (event.type)
+    {
+        case Video::TimelineRegister:
+            snprintf(text, size, "REG %X = $%02X", event.index, event.value);
+            break;
+        case Video::TimelineHINT:
+            snprintf(text, size, "HINT (REG A = $%02X)", event.value);
+            break;
+        case Video::TimelineVINT:
+            snprintf(text, size, "VINT");
+            break;
+        case Video::TimelineStatus:
+            snprintf(text, size, "STATUS READ = $%02X", event.value);
+            break;
+        case Video::TimelineScrollX:
+            snprintf(text, size, "SCROLL X = $%02X", event.value);
+            break;
+        case Video::TimelineScrollY:
+            snprintf(text, size, "SCROLL Y = $%02X", event.value);
+            break;
+        default:
+            snprintf(text, size, "?");
+            break;
+    }
+}
+
 static void add_symbol(const char* line)
 {
     Log("Loading symbol %s", line);
@@ -1347,7 +1890,135 @@ static void add_symbol(const char* line)
             s.bank = 0;
         }
 
-        symbols.push_back(s);
+        symbols[symbol_key(s.bank, s.address)].push_back(s.text);
+        symbols_revision++;
+
+        emu_get_core()->GetProfiler()->AddSymbol(s.bank, s.address, s.text.c_str());
+    }
+}
+
+static u64 symbol_key(int bank, int address)
+{
+    return ((u64)(unsigned int)bank << 32) | (unsigned int)address;
+}
+
+static void debug_watchpoints(void)
+{
+    Watchpoints* watchpoints = emu_get_core()->GetWatchpoints();
+    const char* space_names[] = { "CPU", "VRAM", "I/O" };
+
+    ImGui::PushItemWidth(60);
+    ImGui::Combo("##watch_space", &watch_space, "CPU\0VRAM\0I/O\0\0");
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+
+    ImGui::PushItemWidth(90);
+    ImGui::InputTextWithHint("##watch_range", "XXXX-XXXX", watch_range, IM_ARRAYSIZE(watch_range), ImGuiInputTextFlags_AutoSelectAll);
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+
+    ImGui::Checkbox("R", &watch_read); ImGui::SameLine();
+    ImGui::Checkbox("W", &watch_write);
+
+    ImGui::PushItemWidth(250);
+    if (ImGui::InputTextWithHint("##watch_condition", "A==3 && [C000]>10", watch_condition, IM_ARRAYSIZE(watch_condition), ImGuiInputTextFlags_EnterReturnsTrue))
+    {
+        add_watchpoint();
+    }
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+
+    if (ImGui::Button("Add"))
+    {
+        add_watchpoint();
+    }
+    ImGui::SameLine();
+
+    if (ImGui::Button("Clear All"))
+    {
+        watchpoints->Clear();
+    }
+
+    if (!watch_error.empty())
+        ImGui::TextColored(red, "%s", watch_error.c_str());
+
+    ImGui::BeginChild("watchpoints", ImVec2(0, 74), false);
+
+    for (int i = 0; i < watchpoints->GetCount(); i++)
+    {
+        const Watchpoints::Watchpoint* watchpoint = watchpoints->Get(i);
+        bool enabled = watchpoint->enabled;
+
+        ImGui::PushID(i);
+        if (ImGui::SmallButton("X"))
+        {
+            watchpoints->Remove(i);
+            ImGui::PopID();
+            break;
+        }
+        ImGui::SameLine();
+        if (ImGui::Checkbox("##enabled", &enabled))
+        {
+            watchpoints->SetEnabled(i, enabled);
+        }
+        ImGui::PopID();
+
+        ImGui::PushFont(gui_default_font);
+        ImGui::SameLine();
+        ImGui::TextColored(red, "%-4s %04X-%04X %s%s", space_names[watchpoint->space], watchpoint->start, watchpoint->end, (watchpoint->access & Watchpoints::AccessRead) ? "R" : "", (watchpoint->access & Watchpoints::AccessWrite) ? "W" : "");
+        ImGui::SameLine();
+        ImGui::TextColored(gray, "%s", watchpoint->condition.c_str());
+        ImGui::SameLine();
+        ImGui::TextColored(cyan, "(%u)", watchpoint->hits);
+        ImGui::PopFont();
+    }
+
+    ImGui::EndChild();
+
+    const Watchpoints::Hit* hit = watchpoints->GetLastHit();
+
+    if (IsValidPointer(hit))
+    {
+        ImGui::PushFont(gui_default_font);
+        ImGui::TextColored(yellow, "Last hit:");
+        ImGui::SameLine();
+        ImGui::TextColored(white, "%s %s $%04X = $%02X", space_names[hit->space], (hit->access & Watchpoints::AccessRead) ? "read" : "write", hit->address, hit->value);
+        ImGui::PopFont();
+    }
+
+    ImGui::Separator();
+}
+
+static void add_watchpoint(void)
+{
+    std::string range(watch_range);
+    std::size_t separator = range.find("-");
+    u8 access = (watch_read ? Watchpoints::AccessRead : 0) | (watch_write ? Watchpoints::AccessWrite : 0);
+    unsigned long start, end;
+
+    try
+    {
+        start = std::stoul(range.substr(0, separator), 0, 16);
+        end = (separator != std::string::npos) ? std::stoul(range.substr(separator + 1), 0, 16) : start;
+    }
+    catch (...)
+    {
+        watch_error = "Invalid address range";
+        return;
+    }
+
+    if ((start > 0xFFFF) || (end > 0xFFFF))
+    {
+        watch_error = "Invalid address range";
+        return;
+    }
+
+    watch_error.clear();
+
+    if (emu_get_core()->GetWatchpoints()->Add((Watchpoints::Space)watch_space, (u16)start, (u16)end, access, watch_condition, &watch_error))
+    {
+        watch_range[0] = 0;
+        watch_condition[0] = 0;
     }
 }
 
@@ -1397,27 +2068,120 @@ static void add_breakpoint(void)
     }
     else
     {
+        target_offset = target_address;
         map = memoryMap;
     }
 
     brk_address[0] = 0;
 
-    bool found = false;
-    std::vector<Memory::stDisassembleRecord*>* breakpoints = emu_get_core()->GetMemory()->GetBreakpoints();
+    emu_get_core()->GetMemory()->AddBreakpoint(map[target_offset]);
+}
+
+static void update_disassembler_cache(Memory* memory, bool show_symbols)
+{
+    MemoryRule* rule = memory->GetCurrentRule();
+    DisassemblerCache& cache = disassembler_cache;
+
+    int banks[3] = { rule->GetBank(0), rule->GetBank(1), rule->GetBank(2) };
+
+    // The list only changes when new code is found, a different bank is
+    // paged in or the symbols change
+    if (!cache.lines.empty() &&
+        (cache.disassembly_revision == memory->GetDisassemblyRevision()) &&
+        (cache.symbols_revision == symbols_revision) &&
+        (cache.show_symbols == show_symbols) &&
+        (cache.banks[0] == banks[0]) && (cache.banks[1] == banks[1]) && (cache.banks[2] == banks[2]))
+        return;
+
+    cache.disassembly_revision = memory->GetDisassemblyRevision();
+    cache.symbols_revision = symbols_revision;
+    cache.show_symbols = show_symbols;
+    cache.banks[0] = banks[0];
+    cache.banks[1] = banks[1];
+    cache.banks[2] = banks[2];
+    cache.lines.clear();
+
+    Memory::stDisassembleRecord** memoryMap = memory->GetDisassembledMemoryMap();
+    Memory::stDisassembleRecord** romMap = memory->GetDisassembledROMMemoryMap();
+    Memory::stDisassembleRecord** map = NULL;
 
-    for (long unsigned int b = 0; b < breakpoints->size(); b++)
+    for (int i = 0; i < 0x10000; i++)
     {
-        if ((*breakpoints)[b] == map[target_offset])
+        int offset = i;
+        int bank = 0;
+
+        switch (i & 0xC000)
         {
-            found = true;
+        case 0x0000:
+            bank = banks[0];
+            offset = (0x4000 * bank) + i;
+            map = romMap;
+            break;
+        case 0x4000:
+            bank = banks[1];
+            offset = (0x4000 * bank) + (i & 0x3FFF);
+            map = romMap;
+            break;
+        case 0x8000:
+            bank = banks[2];
+            offset = (0x4000 * bank) + (i & 0x3FFF);
+            map = romMap;
             break;
+        default:
+            map = memoryMap;
+        }
+
+        if (IsValidPointer(map[offset]) && (map[offset]->name[0] != 0))
+        {
+            DisassmeblerLine line;
+            line.address = i;
+            line.record = map[offset];
+
+            if (show_symbols)
+            {
+                DebugSymbolMap::const_iterator it = symbols.find(symbol_key(bank, offset));
+
+                if (it != symbols.end())
+                {
+                    line.is_symbol = true;
+
+                    for (long unsigned int s = 0; s < it->second.size(); s++)
+                    {
+                        line.symbol = &it->second[s];
+                        cache.lines.push_back(line);
+                    }
+                }
+            }
+
+            line.is_symbol = false;
+            line.symbol = NULL;
+            cache.lines.push_back(line);
         }
     }
+}
+
+static int find_disassembler_line(u16 address)
+{
+    std::vector<DisassmeblerLine>& lines = disassembler_cache.lines;
+
+    int low = 0;
+    int high = (int)lines.size();
 
-    if (!found)
+    // Lines are sorted by address, symbol labels go before their instruction
+    while (low < high)
     {
-        breakpoints->push_back(map[target_offset]);
+        int middle = (low + high) / 2;
+
+        if ((lines[middle].address < address) || ((lines[middle].address == address) && lines[middle].is_symbol))
+            low = middle + 1;
+        else
+            high = middle;
     }
+
+    if ((low < (int)lines.size()) && (lines[low].address == address))
+        return low;
+
+    return 0;
 }
 
 static ImVec4 color_444_to_float(u16 color)
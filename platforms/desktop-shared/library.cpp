@@ -0,0 +1,411 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <ctype.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include "FileBrowser/Dirent/dirent.h"
+#else
+#include <dirent.h>
+#endif
+
+#define LIBRARY_IMPORT
+#include "library.h"
+
+#define LIBRARY_CACHE_MAGIC "GEARSYSTEM_LIBRARY_3"
+
+// Every file maps to its entries, archives with several ROMs have one each
+typedef std::unordered_map<std::string, std::vector<library_Entry> > library_Cache;
+
+static std::string cache_file;
+static library_Cache cache;
+static std::thread scan_thread;
+static std::atomic<bool> scan_running(false);
+static std::atomic<bool> scan_cancel(false);
+static std::atomic<int> scan_done(0);
+static std::atomic<int> scan_total(0);
+static std::mutex entries_mutex;
+static std::vector<library_Entry> entries;
+static unsigned int revision = 0;
+
+static void scan(std::string path, bool recursive);
+static void find_files(const std::string& path, bool recursive, std::vector<library_Entry>& files);
+static bool is_rom_extension(const std::string& name);
+static bool is_in_scan(const std::string& file, const std::string& root, bool recursive);
+static void identify(const library_Entry& file, std::vector<library_Entry>& out);
+static void apply_probe(library_Entry& entry, bool valid, const Cartridge::ProbeResult& probe);
+static bool compare_entries(const library_Entry& a, const library_Entry& b);
+static void load_cache(void);
+static void save_cache(void);
+
+void library_init(const char* cache_path, const char* library_path, bool recursive)
+{
+    cache_file = std::string(cache_path) + "library.cache";
+    load_cache();
+
+    if (!IsValidPointer(library_path) || (strlen(library_path) == 0))
+        return;
+
+    // Show the last scan right away, a new scan refreshes it when requested
+    std::vector<library_Entry> found;
+
+    for (library_Cache::const_iterator it = cache.begin(); it != cache.end(); ++it)
+    {
+        if (is_in_scan(it->first, library_path, recursive))
+            found.insert(found.end(), it->second.begin(), it->second.end());
+    }
+
+    std::sort(found.begin(), found.end(), compare_entries);
+
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    entries.swap(found);
+    revision++;
+}
+
+void library_destroy(void)
+{
+    library_cancel();
+}
+
+void library_scan(const char* path, bool recursive)
+{
+    library_cancel();
+
+    scan_cancel = false;
+    scan_running = true;
+    scan_done = 0;
+    scan_total = 0;
+
+    scan_thread = std::thread(scan, std::string(path), recursive);
+}
+
+void library_cancel(void)
+{
+    scan_cancel = true;
+
+    if (scan_thread.joinable())
+        scan_thread.join();
+}
+
+bool library_is_scanning(void)
+{
+    return scan_running;
+}
+
+void library_get_progress(int& done, int& total)
+{
+    done = scan_done;
+    total = scan_total;
+}
+
+unsigned int library_get_revision(void)
+{
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    return revision;
+}
+
+void library_get_entries(std::vector<library_Entry>& out)
+{
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    out = entries;
+}
+
+static void scan(std::string path, bool recursive)
+{
+    std::vector<library_Entry> files;
+    std::vector<size_t> pending;
+
+    find_files(path, recursive, files);
+
+    std::vector<std::vector<library_Entry> > results(files.size());
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        library_Cache::const_iterator it = cache.find(files[i].path);
+
+        if ((it != cache.end()) && !it->second.empty() && (it->second[0].mtime == files[i].mtime) && (it->second[0].size == files[i].size))
+            results[i] = it->second;
+        else
+            pending.push_back(i);
+    }
+
+    Log("Library: %d files found, %d not cached", (int)files.size(), (int)pending.size());
+
+    scan_total = static_cast<int>(pending.size());
+
+    std::atomic<size_t> next(0);
+    int thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    thread_count = std::min(thread_count, std::max(1, static_cast<int>(pending.size())));
+
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < thread_count; t++)
+    {
+        workers.push_back(std::thread([&files, &results, &pending, &next]()
+        {
+            for (size_t i = next++; (i < pending.size()) && !scan_cancel; i = next++)
+            {
+                identify(files[pending[i]], results[pending[i]]);
+                scan_done++;
+            }
+        }));
+    }
+
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    if (!scan_cancel)
+    {
+        std::vector<library_Entry> found;
+
+        for (size_t i = 0; i < results.size(); i++)
+            found.insert(found.end(), results[i].begin(), results[i].end());
+
+        std::sort(found.begin(), found.end(), compare_entries);
+
+        // Other folders keep their entries, only files gone from this one
+        // are dropped
+        for (library_Cache::iterator it = cache.begin(); it != cache.end();)
+        {
+            if (is_in_scan(it->first, path, recursive))
+                it = cache.erase(it);
+            else
+                ++it;
+        }
+
+        for (size_t i = 0; i < files.size(); i++)
+            cache[files[i].path] = results[i];
+
+        save_cache();
+
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        entries.swap(found);
+        revision++;
+    }
+
+    scan_running = false;
+}
+
+static void find_files(const std::string& path, bool recursive, std::vector<library_Entry>& files)
+{
+    DIR* dir = opendir(path.c_str());
+
+    if (!IsValidPointer(dir))
+        return;
+
+    struct dirent* ent;
+
+    while (IsValidPointer(ent = readdir(dir)) && !scan_cancel)
+    {
+        std::string name(ent->d_name);
+
+        if ((name == ".") || (name == ".."))
+            continue;
+
+        std::string full_path = path;
+        if ((full_path.length() > 0) && (full_path[full_path.length() - 1] != '/') && (full_path[full_path.length() - 1] != '\\'))
+            full_path += "/";
+        full_path += name;
+
+        struct stat st;
+
+        if (stat(full_path.c_str(), &st) != 0)
+            continue;
+
+        if (S_ISDIR(st.st_mode))
+        {
+            if (recursive)
+                find_files(full_path, recursive, files);
+        }
+        else if (is_rom_extension(name))
+        {
+            library_Entry entry;
+            entry.path = full_path;
+            entry.zip_entry = -1;
+            entry.mtime = static_cast<long long>(st.st_mtime);
+            entry.size = static_cast<long long>(st.st_size);
+            entry.crc = 0;
+            entry.system = Cartridge::CartridgeUnknownSystem;
+            entry.mapper = Cartridge::CartridgeNotSupported;
+            entry.zone = Cartridge::CartridgeUnknownZone;
+            entry.pal = false;
+            entry.valid = false;
+            files.push_back(entry);
+        }
+    }
+
+    closedir(dir);
+}
+
+static bool is_rom_extension(const std::string& name)
+{
+    std::string extension = name.substr(name.find_last_of(".") + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    return (extension == "sms") || (extension == "gg") || (extension == "sg") || (extension == "mv") ||
+           (extension == "rom") || (extension == "bin") || (extension == "zip");
+}
+
+static bool is_in_scan(const std::string& file, const std::string& root, bool recursive)
+{
+    std::string prefix = root;
+    if ((prefix.length() > 0) && (prefix[prefix.length() - 1] != '/') && (prefix[prefix.length() - 1] != '\\'))
+        prefix += "/";
+
+    if (file.compare(0, prefix.length(), prefix) != 0)
+        return false;
+
+    return recursive || (file.find_first_of("/\\", prefix.length()) == std::string::npos);
+}
+
+static void identify(const library_Entry& file, std::vector<library_Entry>& out)
+{
+    // Streams the file through the CRC, the ROM is never fully allocated.
+    // Archives are opened once and every ROM inside is probed
+    std::vector<Cartridge::ZipEntry> zip_entries;
+    std::vector<Cartridge::ProbeResult> probes;
+    std::string extension = file.path.substr(file.path.find_last_of(".") + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    out.clear();
+
+    if ((extension == "zip") && Cartridge::ProbeZip(file.path.c_str(), zip_entries, probes, true) && (zip_entries.size() > 1))
+    {
+        for (size_t i = 0; i < zip_entries.size(); i++)
+        {
+            library_Entry entry = file;
+            entry.zip_entry = static_cast<int>(i);
+            apply_probe(entry, probes[i].rom_size > 0, probes[i]);
+
+            if (entry.title.empty())
+                entry.title = zip_entries[i].name.substr(zip_entries[i].name.find_last_of("/\\") + 1);
+
+            out.push_back(entry);
+        }
+
+        return;
+    }
+
+    library_Entry entry = file;
+    Cartridge::ProbeResult probe;
+
+    if (probes.size() == 1)
+        apply_probe(entry, probes[0].rom_size > 0, probes[0]);
+    else
+        apply_probe(entry, Cartridge::Probe(entry.path.c_str(), probe, true), probe);
+
+    if (entry.title.empty())
+        entry.title = entry.path.substr(entry.path.find_last_of("/\\") + 1);
+
+    out.push_back(entry);
+}
+
+static void apply_probe(library_Entry& entry, bool valid, const Cartridge::ProbeResult& probe)
+{
+    entry.valid = valid;
+
+    if (entry.valid)
+    {
+        entry.title = probe.title;
+        entry.crc = probe.crc;
+        entry.system = probe.system;
+        entry.mapper = probe.type;
+        entry.zone = probe.zone;
+        entry.pal = (probe.region == Cartridge::CartridgePAL);
+    }
+}
+
+static bool compare_entries(const library_Entry& a, const library_Entry& b)
+{
+    return a.title < b.title;
+}
+
+static void load_cache(void)
+{
+    using namespace std;
+
+    ifstream file(cache_file.c_str(), ios::in);
+
+    if (!file.is_open())
+        return;
+
+    string line;
+
+    if (!getline(file, line) || (line != LIBRARY_CACHE_MAGIC))
+    {
+        Log("Library: ignoring outdated cache %s", cache_file.c_str());
+        return;
+    }
+
+    while (getline(file, line))
+    {
+        library_Entry entry;
+        int system, mapper, zone, pal, valid;
+        int title_start = 0;
+
+        if (sscanf(line.c_str(), "%x %lld %lld %d %d %d %d %d %d %n", &entry.crc, &entry.mtime, &entry.size, &system, &mapper, &zone, &pal, &valid, &entry.zip_entry, &title_start) != 9)
+            continue;
+
+        size_t separator = line.find('\t', title_start);
+
+        if (separator == string::npos)
+            continue;
+
+        entry.title = line.substr(title_start, separator - title_start);
+        entry.path = line.substr(separator + 1);
+        entry.system = static_cast<Cartridge::CartridgeSystem>(system);
+        entry.mapper = static_cast<Cartridge::CartridgeTypes>(mapper);
+        entry.zone = static_cast<Cartridge::CartridgeZones>(zone);
+        entry.pal = (pal != 0);
+        entry.valid = (valid != 0);
+
+        cache[entry.path].push_back(entry);
+    }
+
+    Log("Library: %d cached entries loaded from %s", (int)cache.size(), cache_file.c_str());
+}
+
+static void save_cache(void)
+{
+    FILE* file = fopen(cache_file.c_str(), "w");
+
+    if (!IsValidPointer(file))
+    {
+        Log("Library: unable to write cache %s", cache_file.c_str());
+        return;
+    }
+
+    fprintf(file, "%s\n", LIBRARY_CACHE_MAGIC);
+
+    for (library_Cache::const_iterator it = cache.begin(); it != cache.end(); ++it)
+    {
+        for (size_t i = 0; i < it->second.size(); i++)
+        {
+            const library_Entry& e = it->second[i];
+            fprintf(file, "%08x %lld %lld %d %d %d %d %d %d %s\t%s\n", e.crc, e.mtime, e.size, e.system, e.mapper, e.zone, e.pal ? 1 : 0, e.valid ? 1 : 0, e.zip_entry, e.title.c_str(), e.path.c_str());
+        }
+    }
+
+    fclose(file);
+}
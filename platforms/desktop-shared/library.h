@@ -0,0 +1,60 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef LIBRARY_H
+#define	LIBRARY_H
+
+#include <string>
+#include <vector>
+#include "../../src/gearsystem.h"
+
+#ifdef LIBRARY_IMPORT
+    #define EXTERN
+#else
+    #define EXTERN extern
+#endif
+
+struct library_Entry
+{
+    std::string path;
+    // ROM inside a multi-ROM archive, -1 for plain files and single-ROM archives
+    int zip_entry;
+    std::string title;
+    long long mtime;
+    long long size;
+    u32 crc;
+    Cartridge::CartridgeSystem system;
+    Cartridge::CartridgeTypes mapper;
+    Cartridge::CartridgeZones zone;
+    bool pal;
+    bool valid;
+};
+
+EXTERN void library_init(const char* cache_path, const char* library_path, bool recursive);
+EXTERN void library_destroy(void);
+EXTERN void library_scan(const char* path, bool recursive);
+EXTERN void library_cancel(void);
+EXTERN bool library_is_scanning(void);
+EXTERN void library_get_progress(int& done, int& total);
+EXTERN unsigned int library_get_revision(void);
+EXTERN void library_get_entries(std::vector<library_Entry>& entries);
+
+#undef LIBRARY_IMPORT
+#undef EXTERN
+#endif	/* LIBRARY_H */
@@ -0,0 +1,162 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#define PACING_IMPORT
+#include "pacing.h"
+
+#define PACING_HISTORY 128
+#define PACING_SPIN_MS 2.0f
+#define PACING_DELAY_MARGIN_MS 2.0f
+#define PACING_DELAY_STEP_MS 0.25f
+
+static double counter_ms;
+static float nominal_frame_time;
+static float display_frame_time;
+static Uint64 last_present;
+static float frame_times[PACING_HISTORY];
+static float work_times[PACING_HISTORY];
+static int history_pos = 0;
+static int history_count = 0;
+static float frame_delay = 0.0f;
+
+static void update_frame_delay(float interval, bool enabled);
+
+void pacing_init(SDL_Window* window)
+{
+    counter_ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    SDL_DisplayMode mode;
+    int rate = 60;
+
+    if ((SDL_GetWindowDisplayMode(window, &mode) == 0) && (mode.refresh_rate > 0))
+        rate = mode.refresh_rate;
+
+    nominal_frame_time = display_frame_time = 1000.0f / rate;
+    last_present = pacing_now();
+}
+
+Uint64 pacing_now(void)
+{
+    return SDL_GetPerformanceCounter();
+}
+
+float pacing_elapsed(Uint64 from, Uint64 to)
+{
+    return (float)((double)(to - from) * counter_ms);
+}
+
+void pacing_wait(Uint64 from, float ms)
+{
+    Uint64 target = from + (Uint64)(ms / counter_ms);
+
+    // Sleep through most of the wait and spin the rest, scheduler
+    // wake ups are too coarse to hit the target on their own
+    while (true)
+    {
+        Uint64 now = pacing_now();
+
+        if (now >= target)
+            break;
+
+        float remaining = pacing_elapsed(now, target);
+
+        if (remaining > PACING_SPIN_MS)
+            std::this_thread::sleep_for(std::chrono::microseconds((long long)((remaining - PACING_SPIN_MS) * 1000.0f)));
+        else
+            std::this_thread::yield();
+    }
+}
+
+void pacing_wait_frame_delay(void)
+{
+    if (frame_delay > 0.0f)
+        pacing_wait(last_present, frame_delay);
+}
+
+void pacing_frame_presented(float work, bool auto_delay)
+{
+    Uint64 now = pacing_now();
+    float interval = pacing_elapsed(last_present, now);
+    last_present = now;
+
+    frame_times[history_pos] = interval;
+    work_times[history_pos] = work;
+    history_pos = (history_pos + 1) % PACING_HISTORY;
+    history_count = std::min(history_count + 1, PACING_HISTORY);
+
+    // Swaps land on display refreshes when vsync is honored, anything
+    // far from the reported rate is a hitch or a disabled vsync
+    if ((interval > (nominal_frame_time * 0.75f)) && (interval < (nominal_frame_time * 1.25f)))
+        display_frame_time += (interval - display_frame_time) * 0.05f;
+
+    update_frame_delay(interval, auto_delay);
+}
+
+float pacing_display_frame_time(void)
+{
+    return display_frame_time;
+}
+
+void pacing_get_stats(pacing_Stats& stats)
+{
+    float mean = 0.0f;
+    float variance = 0.0f;
+
+    for (int i = 0; i < history_count; i++)
+        mean += frame_times[i];
+
+    if (history_count > 0)
+        mean /= history_count;
+
+    for (int i = 0; i < history_count; i++)
+        variance += (frame_times[i] - mean) * (frame_times[i] - mean);
+
+    if (history_count > 1)
+        variance /= (history_count - 1);
+
+    stats.frame_time = mean;
+    stats.frame_time_deviation = sqrtf(variance);
+    stats.display_rate = 1000.0f / display_frame_time;
+    stats.frame_delay = frame_delay;
+}
+
+static void update_frame_delay(float interval, bool enabled)
+{
+    // A missed refresh drops the delay at once, then it creeps back
+    // towards what the slowest recent frame leaves free
+    if (!enabled || (interval > (display_frame_time * 1.5f)))
+    {
+        frame_delay = 0.0f;
+        return;
+    }
+
+    float worst = 0.0f;
+
+    for (int i = 0; i < history_count; i++)
+        worst = std::max(worst, work_times[i]);
+
+    float target = std::max(0.0f, display_frame_time - worst - PACING_DELAY_MARGIN_MS);
+
+    frame_delay = std::min(target, frame_delay + PACING_DELAY_STEP_MS);
+}
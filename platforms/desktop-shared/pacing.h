@@ -0,0 +1,50 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef PACING_H
+#define	PACING_H
+
+#include <SDL.h>
+
+#ifdef PACING_IMPORT
+    #define EXTERN
+#else
+    #define EXTERN extern
+#endif
+
+struct pacing_Stats
+{
+    float frame_time;
+    float frame_time_deviation;
+    float display_rate;
+    float frame_delay;
+};
+
+EXTERN void pacing_init(SDL_Window* window);
+EXTERN Uint64 pacing_now(void);
+EXTERN float pacing_elapsed(Uint64 from, Uint64 to);
+EXTERN void pacing_wait(Uint64 from, float ms);
+EXTERN void pacing_wait_frame_delay(void);
+EXTERN void pacing_frame_presented(float work, bool auto_delay);
+EXTERN float pacing_display_frame_time(void);
+EXTERN void pacing_get_stats(pacing_Stats& stats);
+
+#undef PACING_IMPORT
+#undef EXTERN
+#endif	/* PACING_H */
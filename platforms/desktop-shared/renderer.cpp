@@ -29,6 +29,7 @@
 #include "imgui/imgui_impl_opengl2.h"
 #include "emu.h"
 #include "config.h"
+#include "pacing.h"
 #include "../../src/gearsystem.h"
 
 #define RENDERER_IMPORT
@@ -39,6 +40,10 @@ static uint32_t system_texture[3];
 static uint32_t scanlines_texture;
 static uint32_t current_system_texture;
 static uint32_t frame_buffer_object[3];
+static uint32_t pixel_buffer_object[2];
+static int current_pbo;
+static bool pbo_enabled;
+static u32* upload_buffer;
 static uint32_t current_fbo;
 static GS_RuntimeInfo current_runtime;
 static bool first_frame;
@@ -56,6 +61,7 @@ static void render_emu_mix(void);
 static void render_emu_bilinear(void);
 static void render_quad(int viewportWidth, int viewportHeight);
 static void update_system_texture(void);
+static void convert_frame(u32* dst, int size);
 static void update_debug_textures(void);
 static void render_scanlines(void);
 
@@ -88,6 +94,9 @@ void renderer_destroy(void)
     glDeleteFramebuffers(3, frame_buffer_object); 
     glDeleteTextures(3, fbo_texture);
     glDeleteTextures(3, system_texture);
+    if (pbo_enabled)
+        glDeleteBuffers(2, pixel_buffer_object);
+    SafeDeleteArray(upload_buffer);
     glDeleteTextures(1, &scanlines_texture);
     glDeleteTextures(1, &renderer_emu_debug_vram_background);
     glDeleteTextures(1, &renderer_emu_debug_vram_tiles);
@@ -165,6 +174,34 @@ static void init_ogl_emu(void)
     glGenTextures(3, fbo_texture);
     glGenTextures(3, system_texture);
 
+    #ifdef __APPLE__
+    pbo_enabled = true;
+    #else
+    pbo_enabled = GLEW_VERSION_2_1;
+    #endif
+
+    InitPointer(upload_buffer);
+    current_pbo = 0;
+    renderer_upload_time = 0.0f;
+
+    if (pbo_enabled)
+    {
+        glGenBuffers(2, pixel_buffer_object);
+
+        for (int i = 0; i < 2; i++)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_object[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT * 4, NULL, GL_STREAM_DRAW);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        Log("Pixel buffer objects not supported, streaming frames from memory");
+        upload_buffer = new u32[GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT];
+    }
+
     init_texture(0, GS_RESOLUTION_GG_WIDTH, GS_RESOLUTION_GG_HEIGHT);
     init_texture(1, GS_RESOLUTION_SMS_WIDTH, GS_RESOLUTION_SMS_HEIGHT);
     init_texture(2, GS_RESOLUTION_SMS_WIDTH, GS_RESOLUTION_SMS_HEIGHT_EXTENDED);
@@ -208,7 +245,7 @@ static void init_texture(int index, int w, int h)
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     glBindTexture(GL_TEXTURE_2D, system_texture[index]);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) emu_frame_buffer);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 }
@@ -276,9 +313,38 @@ static void render_emu_mix(void)
 
 static void update_system_texture(void)
 {
+    Uint64 start = pacing_now();
+    int width = current_runtime.screen_width;
+    int height = current_runtime.screen_height;
+
     glBindTexture(GL_TEXTURE_2D, current_system_texture);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, current_runtime.screen_width, current_runtime.screen_height,
-            GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) emu_frame_buffer);
+
+    // Frames go up as 32 bit pixels, packed RGB takes a slow path on
+    // many drivers. Only the active screen is sent, rows are packed.
+    if (pbo_enabled)
+    {
+        // Alternating buffers so mapping never waits on the last upload
+        current_pbo ^= 1;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_object[current_pbo]);
+
+        u32* pixels = static_cast<u32*>(glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+
+        if (IsValidPointer(pixels))
+        {
+            convert_frame(pixels, width * height);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, 0);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        convert_frame(upload_buffer, width * height);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, (GLvoid*) upload_buffer);
+    }
+
+    renderer_upload_time += (pacing_elapsed(start, pacing_now()) - renderer_upload_time) * 0.05f;
 
     if (config_video.bilinear)
     {
@@ -292,21 +358,46 @@ static void update_system_texture(void)
     }
 }
 
+static void convert_frame(u32* dst, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        GS_Color color = emu_frame_buffer[i];
+        dst[i] = 0xFF000000 | (color.blue << 16) | (color.green << 8) | color.red;
+    }
+}
+
 static void update_debug_textures(void)
 {
-    glBindTexture(GL_TEXTURE_2D, renderer_emu_debug_vram_background);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 256,
-            GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) emu_debug_background_buffer);
+    if (emu_debug_background_dirty[0] <= emu_debug_background_dirty[1])
+    {
+        int rows = emu_debug_background_dirty[1] - emu_debug_background_dirty[0] + 1;
+        glBindTexture(GL_TEXTURE_2D, renderer_emu_debug_vram_background);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, emu_debug_background_dirty[0], 256, rows,
+                GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) (emu_debug_background_buffer + (emu_debug_background_dirty[0] * 256)));
+        emu_debug_background_dirty[0] = 256;
+        emu_debug_background_dirty[1] = -1;
+    }
 
-    glBindTexture(GL_TEXTURE_2D, renderer_emu_debug_vram_tiles);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 32 * 8, 32 * 8,
-                GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) emu_debug_tile_buffer);
+    if (emu_debug_tile_dirty[0] <= emu_debug_tile_dirty[1])
+    {
+        int rows = emu_debug_tile_dirty[1] - emu_debug_tile_dirty[0] + 1;
+        glBindTexture(GL_TEXTURE_2D, renderer_emu_debug_vram_tiles);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, emu_debug_tile_dirty[0], 32 * 8, rows,
+                    GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) (emu_debug_tile_buffer + (emu_debug_tile_dirty[0] * 32 * 8)));
+        emu_debug_tile_dirty[0] = 256;
+        emu_debug_tile_dirty[1] = -1;
+    }
 
     for (int s = 0; s < 64; s++)
     {
+        if (!emu_debug_sprite_dirty[s])
+            continue;
+
         glBindTexture(GL_TEXTURE_2D, renderer_emu_debug_vram_sprites[s]);
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 16, 16,
                 GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) emu_debug_sprite_buffers[s]);
+        emu_debug_sprite_dirty[s] = false;
     }
 }
 
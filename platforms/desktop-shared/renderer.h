@@ -32,6 +32,8 @@ EXTERN uint32_t renderer_emu_debug_vram_tiles;
 EXTERN uint32_t renderer_emu_debug_vram_sprites[64];
 EXTERN const char* renderer_glew_version;
 EXTERN const char* renderer_opengl_version;
+// Smoothed time in ms to convert and upload the emulator frame
+EXTERN float renderer_upload_time;
 
 EXTERN void renderer_init(void);
 EXTERN void renderer_destroy(void);
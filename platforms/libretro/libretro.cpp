@@ -32,6 +32,12 @@
 
 #include "../../src/gearsystem.h"
 
+#ifdef _WIN32
+static const char slash = '\\';
+#else
+static const char slash = '/';
+#endif
+
 static struct retro_log_callback logging;
 static retro_log_printf_t log_cb;
 static char retro_base_directory[4096];
@@ -44,8 +50,9 @@ static int current_screen_height = 0;
 static bool allow_up_down = false;
 
 static GearsystemCore* core;
-static GS_Color *frame_buf;
-static u16* frame_buf_16bit;
+static u8* frame_buf;
+static enum retro_pixel_format pixel_format = RETRO_PIXEL_FORMAT_XRGB8888;
+static int pixel_size = 4;
 static Cartridge::ForceConfiguration config;
 
 static void fallback_log(enum retro_log_level level, const char *fmt, ...)
@@ -83,14 +90,17 @@ void retro_init(void)
     if (environ_cb(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &dir) && dir)
     {
         snprintf(retro_base_directory, sizeof(retro_base_directory), "%s", dir);
+
+        char db_path[4200];
+        snprintf(db_path, sizeof(db_path), "%s%cgearsystem_gamedb.dat", retro_base_directory, slash);
+        Cartridge::LoadDatabase(db_path);
     }
 
     core = new GearsystemCore();
     core->Init();
     core->SetSG1000Palette(sg1000_palette);
 
-    frame_buf = new GS_Color[GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT];
-    frame_buf_16bit = new u16[GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT];
+    frame_buf = new u8[GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT * 4];
 
     audio_sample_count = 0;
 
@@ -103,8 +113,8 @@ void retro_init(void)
 void retro_deinit(void)
 {
     SafeDeleteArray(frame_buf);
-    SafeDeleteArray(frame_buf_16bit);
     SafeDelete(core);
+    Log_flush();
 }
 
 unsigned retro_api_version(void)
@@ -352,8 +362,28 @@ void retro_run(void)
 
     update_input();
 
-    core->RunToVBlank(frame_buf, audio_buf, &audio_sample_count);
-    core->Get16BitFrameBuffer(frame_buf, frame_buf_16bit);
+    // Render straight into the frontend buffer when it offers one in our
+    // format, the frame is presented with the size it was requested for
+    int width = current_screen_width;
+    int height = current_screen_height;
+    void* buffer = frame_buf;
+    size_t pitch = width * pixel_size;
+
+    retro_framebuffer fb;
+    fb.width = width;
+    fb.height = height;
+    fb.access_flags = RETRO_MEMORY_ACCESS_WRITE;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb) && IsValidPointer(fb.data) && (fb.format == pixel_format))
+    {
+        buffer = fb.data;
+        pitch = fb.pitch;
+        core->SetFrameBufferLayout(static_cast<int>(fb.pitch), height);
+    }
+    else
+        core->SetFrameBufferLayout(0, GS_RESOLUTION_MAX_HEIGHT);
+
+    core->RunToVBlank(buffer, audio_buf, &audio_sample_count);
 
     GS_RuntimeInfo runtime_info;
     core->GetRuntimeInfo(runtime_info);
@@ -373,7 +403,14 @@ void retro_run(void)
         environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &info.geometry);
     }
 
-    video_cb((uint8_t*)frame_buf_16bit, runtime_info.screen_width, runtime_info.screen_height, runtime_info.screen_width * sizeof(u16));
+    if (buffer == frame_buf)
+    {
+        width = runtime_info.screen_width;
+        height = runtime_info.screen_height;
+        pitch = width * pixel_size;
+    }
+
+    video_cb(buffer, width, height, pitch);
 
     if (audio_sample_count > 0)
         audio_batch_cb(audio_buf, audio_sample_count / 2);
@@ -406,13 +443,25 @@ bool retro_load_game(const struct retro_game_info *info)
 
     environ_cb(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
 
-    enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_RGB565;
-    if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
+    pixel_format = RETRO_PIXEL_FORMAT_XRGB8888;
+    pixel_size = 4;
+
+    if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixel_format))
     {
-        log_cb(RETRO_LOG_INFO, "RGB565 is not supported.\n");
-        return false;
+        log_cb(RETRO_LOG_INFO, "XRGB8888 is not supported, trying RGB565.\n");
+
+        pixel_format = RETRO_PIXEL_FORMAT_RGB565;
+        pixel_size = 2;
+
+        if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixel_format))
+        {
+            log_cb(RETRO_LOG_INFO, "RGB565 is not supported.\n");
+            return false;
+        }
     }
 
+    core->SetPixelFormat((pixel_format == RETRO_PIXEL_FORMAT_XRGB8888) ? Pixel_XRGB8888 : Pixel_RGB565);
+
     snprintf(retro_game_path, sizeof(retro_game_path), "%s", info->path);
 
     bool achievements = true;
@@ -0,0 +1,274 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <algorithm>
+#include "../../src/gearsystem.h"
+#include "gearsystem_env.h"
+
+struct gs_env
+{
+    GearsystemCore* core;
+    GearsystemCore* boot;
+    gs_env_config config;
+    u8* frame;
+    u8* obs;
+    int screen_width;
+    int screen_height;
+    int obs_width;
+    int obs_height;
+    int channels;
+    bool own_obs;
+    unsigned int action;
+    uint64_t frame_count;
+};
+
+static void set_action(gs_env* env, unsigned int action);
+static void update_screen(gs_env* env);
+static void downsample(gs_env* env);
+
+gs_env* gs_env_create(const char* rom_path, const gs_env_config* config)
+{
+    gs_env* env = new gs_env;
+
+    env->config.grayscale = 1;
+    env->config.downsample = 1;
+    env->config.boot_snapshot_dir = NULL;
+    env->config.boot_frames = 0;
+
+    if (IsValidPointer(config))
+        env->config = *config;
+
+    if (env->config.downsample < 1)
+        env->config.downsample = 1;
+
+    env->channels = env->config.grayscale ? 1 : 3;
+    env->frame = new u8[GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT * 3];
+    env->obs = new u8[GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT * 3];
+    env->own_obs = true;
+    env->action = 0;
+    env->frame_count = 0;
+    InitPointer(env->boot);
+
+    memset(env->frame, 0, GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT * 3);
+    memset(env->obs, 0, GS_RESOLUTION_MAX_WIDTH * GS_RESOLUTION_MAX_HEIGHT * 3);
+
+    env->core = new GearsystemCore();
+    env->core->Init();
+    env->core->SetPixelFormat(env->config.grayscale ? Pixel_Gray8 : Pixel_RGB888);
+
+    if (!env->core->LoadROM(rom_path))
+    {
+        gs_env_destroy(env);
+        return NULL;
+    }
+
+    if (env->config.boot_frames > 0)
+    {
+        const char* dir = env->config.boot_snapshot_dir;
+
+        if (!IsValidPointer(dir) || !env->core->LoadBootSnapshot(dir, env->config.boot_frames))
+        {
+            if (IsValidPointer(dir))
+                env->core->CreateBootSnapshot(dir, env->config.boot_frames);
+            else
+            {
+                for (int i = 0; i < env->config.boot_frames; i++)
+                    env->core->RunToVBlank(NULL, NULL, NULL);
+            }
+        }
+
+        // Resets restore this instance instead of powering on again
+        env->boot = new GearsystemCore();
+        env->boot->Init();
+        env->core->Clone(env->boot);
+    }
+
+    // The observation shape is fixed for the lifetime of the environment
+    update_screen(env);
+    env->obs_width = env->screen_width / env->config.downsample;
+    env->obs_height = env->screen_height / env->config.downsample;
+
+    gs_env_reset(env);
+
+    return env;
+}
+
+void gs_env_destroy(gs_env* env)
+{
+    if (!IsValidPointer(env))
+        return;
+
+    SafeDelete(env->core);
+    SafeDelete(env->boot);
+    SafeDeleteArray(env->frame);
+    if (env->own_obs)
+        SafeDeleteArray(env->obs);
+    delete env;
+}
+
+void gs_env_reset(gs_env* env)
+{
+    if (IsValidPointer(env->boot))
+        env->boot->Clone(env->core);
+    else
+        env->core->ResetROM();
+
+    set_action(env, 0);
+
+    env->frame_count = 0;
+    env->core->RunToVBlank(env->frame, NULL, NULL);
+    update_screen(env);
+    downsample(env);
+}
+
+void gs_env_step(gs_env* env, unsigned int action, int frameskip)
+{
+    set_action(env, action);
+
+    // Only the last frame is rendered, the VDP still runs for the others
+    for (int i = 1; i < frameskip; i++)
+        env->core->RunToVBlank(NULL, NULL, NULL);
+
+    env->core->RunToVBlank(env->frame, NULL, NULL);
+    env->frame_count += (frameskip > 1) ? frameskip : 1;
+
+    update_screen(env);
+    downsample(env);
+}
+
+void gs_env_obs_shape(const gs_env* env, int* height, int* width, int* channels)
+{
+    if (IsValidPointer(height))
+        *height = env->obs_height;
+    if (IsValidPointer(width))
+        *width = env->obs_width;
+    if (IsValidPointer(channels))
+        *channels = env->channels;
+}
+
+const uint8_t* gs_env_obs(const gs_env* env)
+{
+    return env->obs;
+}
+
+void gs_env_set_obs_buffer(gs_env* env, uint8_t* buffer)
+{
+    if (env->own_obs)
+        SafeDeleteArray(env->obs);
+
+    env->own_obs = false;
+    env->obs = buffer;
+    downsample(env);
+}
+
+void gs_env_obs_copy(const gs_env* env, uint8_t* dst)
+{
+    memcpy(dst, env->obs, env->obs_width * env->obs_height * env->channels);
+}
+
+uint8_t* gs_env_ram(gs_env* env, int* size)
+{
+    // System RAM, 8KB at 0xC000 (mirrored at 0xE000)
+    if (IsValidPointer(size))
+        *size = 0x2000;
+
+    return env->core->GetMemory()->GetMemoryMap() + 0xC000;
+}
+
+uint64_t gs_env_frame(const gs_env* env)
+{
+    return env->frame_count;
+}
+
+static void set_action(gs_env* env, unsigned int action)
+{
+    unsigned int changed = action ^ env->action;
+
+    for (int pad = 0; pad < 2; pad++)
+    {
+        for (int key = Key_Up; key <= Key_Start; key++)
+        {
+            unsigned int bit = 1 << ((pad << 3) + key);
+
+            if (!(changed & bit))
+                continue;
+
+            if (action & bit)
+                env->core->KeyPressed(static_cast<GS_Joypads>(pad), static_cast<GS_Keys>(key));
+            else
+                env->core->KeyReleased(static_cast<GS_Joypads>(pad), static_cast<GS_Keys>(key));
+        }
+    }
+
+    env->action = action;
+}
+
+static void update_screen(gs_env* env)
+{
+    GS_RuntimeInfo info;
+    env->core->GetRuntimeInfo(info);
+
+    env->screen_width = info.screen_width;
+    env->screen_height = info.screen_height;
+}
+
+static void downsample(gs_env* env)
+{
+    int factor = env->config.downsample;
+    int channels = env->channels;
+    int stride = env->screen_width * channels;
+    int obs_stride = env->obs_width * channels;
+
+    // Games switching to the 224 line mode are cropped, or padded when going back
+    int rows = std::min(env->obs_height, env->screen_height / factor);
+
+    if (rows < env->obs_height)
+        memset(env->obs + (rows * obs_stride), 0, (env->obs_height - rows) * obs_stride);
+
+    if (factor == 1)
+    {
+        memcpy(env->obs, env->frame, rows * stride);
+        return;
+    }
+
+    int area = factor * factor;
+    u8* dst = env->obs;
+
+    for (int y = 0; y < rows; y++)
+    {
+        const u8* src_line = env->frame + (y * factor * stride);
+
+        for (int x = 0; x < env->obs_width; x++)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                const u8* src = src_line + (x * factor * channels) + c;
+                int sum = 0;
+
+                for (int fy = 0; fy < factor; fy++)
+                {
+                    for (int fx = 0; fx < factor; fx++)
+                        sum += src[(fy * stride) + (fx * channels)];
+                }
+
+                *dst++ = static_cast<u8>(sum / area);
+            }
+        }
+    }
+}
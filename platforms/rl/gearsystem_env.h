@@ -0,0 +1,84 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef GEARSYSTEM_ENV_H
+#define	GEARSYSTEM_ENV_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #define GS_ENV_API __declspec(dllexport)
+#else
+    #define GS_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Action bits, joypad 2 uses the same bits shifted left by 8 */
+#define GS_ENV_UP      0x01
+#define GS_ENV_DOWN    0x02
+#define GS_ENV_LEFT    0x04
+#define GS_ENV_RIGHT   0x08
+#define GS_ENV_1       0x10
+#define GS_ENV_2       0x20
+#define GS_ENV_START   0x40
+
+typedef struct gs_env gs_env;
+
+typedef struct gs_env_config
+{
+    int grayscale;                  /* 1: one byte per pixel, 0: RGB888 */
+    int downsample;                 /* integer box filter factor, 1 = full size */
+    const char* boot_snapshot_dir;  /* optional boot snapshot cache */
+    int boot_frames;                /* frames run after power on before the first reset state */
+} gs_env_config;
+
+GS_ENV_API gs_env* gs_env_create(const char* rom_path, const gs_env_config* config);
+GS_ENV_API void gs_env_destroy(gs_env* env);
+GS_ENV_API void gs_env_reset(gs_env* env);
+GS_ENV_API void gs_env_step(gs_env* env, unsigned int action, int frameskip);
+GS_ENV_API void gs_env_obs_shape(const gs_env* env, int* height, int* width, int* channels);
+GS_ENV_API const uint8_t* gs_env_obs(const gs_env* env);
+GS_ENV_API void gs_env_set_obs_buffer(gs_env* env, uint8_t* buffer);
+GS_ENV_API void gs_env_obs_copy(const gs_env* env, uint8_t* dst);
+GS_ENV_API uint8_t* gs_env_ram(gs_env* env, int* size);
+GS_ENV_API uint64_t gs_env_frame(const gs_env* env);
+
+/* M instances of the same ROM stepped in lockstep on a persistent thread
+   pool, every thread always owns the same instances. Observations are
+   written to one contiguous [M][H][W][C] buffer. threads <= 0 uses one
+   thread per hardware core. */
+typedef struct gs_vec_env gs_vec_env;
+
+GS_ENV_API gs_vec_env* gs_vec_env_create(const char* rom_path, int count, int threads, const gs_env_config* config);
+GS_ENV_API void gs_vec_env_destroy(gs_vec_env* vec);
+GS_ENV_API void gs_vec_env_reset(gs_vec_env* vec);
+GS_ENV_API void gs_vec_env_reset_one(gs_vec_env* vec, int index);
+GS_ENV_API void gs_vec_env_step(gs_vec_env* vec, const unsigned int* actions, int frameskip);
+GS_ENV_API void gs_vec_env_obs_shape(const gs_vec_env* vec, int* count, int* height, int* width, int* channels);
+GS_ENV_API const uint8_t* gs_vec_env_obs(const gs_vec_env* vec);
+GS_ENV_API gs_env* gs_vec_env_get(gs_vec_env* vec, int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* GEARSYSTEM_ENV_H */
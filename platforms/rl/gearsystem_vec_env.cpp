@@ -0,0 +1,262 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "../../src/gearsystem.h"
+#include "gearsystem_env.h"
+
+enum vec_Command
+{
+    Command_Create,
+    Command_Attach,
+    Command_Reset,
+    Command_Step,
+    Command_Quit
+};
+
+struct gs_vec_env
+{
+    std::vector<gs_env*> envs;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    unsigned long generation;
+    int pending;
+    int thread_count;
+    vec_Command command;
+    const unsigned int* actions;
+    int frameskip;
+    std::string rom_path;
+    gs_env_config config;
+    u8* obs;
+    size_t obs_size;
+    int obs_height;
+    int obs_width;
+    int obs_channels;
+};
+
+static void worker(gs_vec_env* vec, int thread);
+static void run_command(gs_vec_env* vec, int thread);
+static void dispatch(gs_vec_env* vec, vec_Command command);
+
+gs_vec_env* gs_vec_env_create(const char* rom_path, int count, int threads, const gs_env_config* config)
+{
+    if (count <= 0)
+        return NULL;
+
+    if (threads <= 0)
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    gs_vec_env* vec = new gs_vec_env;
+
+    vec->envs.resize(count, NULL);
+    vec->generation = 0;
+    vec->pending = 0;
+    vec->thread_count = std::min(threads, count);
+    vec->command = Command_Create;
+    vec->actions = NULL;
+    vec->frameskip = 1;
+    vec->rom_path = rom_path;
+    vec->config.grayscale = 1;
+    vec->config.downsample = 1;
+    vec->config.boot_snapshot_dir = NULL;
+    vec->config.boot_frames = 0;
+    vec->obs = NULL;
+    vec->obs_size = 0;
+
+    if (IsValidPointer(config))
+        vec->config = *config;
+
+    // The first instance writes the boot snapshot, if any, so the rest
+    // load it instead of racing to create it
+    vec->envs[0] = gs_env_create(rom_path, &vec->config);
+
+    if (!IsValidPointer(vec->envs[0]))
+    {
+        delete vec;
+        return NULL;
+    }
+
+    // The caller is thread 0
+    for (int t = 1; t < vec->thread_count; t++)
+        vec->workers.push_back(std::thread(worker, vec, t));
+
+    // Instances are created by their owner thread, so their memory is
+    // local to it
+    dispatch(vec, Command_Create);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!IsValidPointer(vec->envs[i]))
+        {
+            Log("Unable to create environment %d", i);
+            gs_vec_env_destroy(vec);
+            return NULL;
+        }
+    }
+
+    gs_env_obs_shape(vec->envs[0], &vec->obs_height, &vec->obs_width, &vec->obs_channels);
+
+    vec->obs_size = vec->obs_height * vec->obs_width * vec->obs_channels;
+    vec->obs = new u8[vec->obs_size * count];
+
+    dispatch(vec, Command_Attach);
+
+    return vec;
+}
+
+void gs_vec_env_destroy(gs_vec_env* vec)
+{
+    if (!IsValidPointer(vec))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(vec->mutex);
+        vec->command = Command_Quit;
+        vec->generation++;
+    }
+
+    vec->start_cv.notify_all();
+
+    for (size_t t = 0; t < vec->workers.size(); t++)
+        vec->workers[t].join();
+
+    for (size_t i = 0; i < vec->envs.size(); i++)
+        gs_env_destroy(vec->envs[i]);
+
+    SafeDeleteArray(vec->obs);
+    delete vec;
+}
+
+void gs_vec_env_reset(gs_vec_env* vec)
+{
+    dispatch(vec, Command_Reset);
+}
+
+void gs_vec_env_reset_one(gs_vec_env* vec, int index)
+{
+    gs_env_reset(vec->envs[index]);
+}
+
+void gs_vec_env_step(gs_vec_env* vec, const unsigned int* actions, int frameskip)
+{
+    vec->actions = actions;
+    vec->frameskip = frameskip;
+    dispatch(vec, Command_Step);
+}
+
+void gs_vec_env_obs_shape(const gs_vec_env* vec, int* count, int* height, int* width, int* channels)
+{
+    if (IsValidPointer(count))
+        *count = static_cast<int>(vec->envs.size());
+    if (IsValidPointer(height))
+        *height = vec->obs_height;
+    if (IsValidPointer(width))
+        *width = vec->obs_width;
+    if (IsValidPointer(channels))
+        *channels = vec->obs_channels;
+}
+
+const uint8_t* gs_vec_env_obs(const gs_vec_env* vec)
+{
+    return vec->obs;
+}
+
+gs_env* gs_vec_env_get(gs_vec_env* vec, int index)
+{
+    return vec->envs[index];
+}
+
+static void worker(gs_vec_env* vec, int thread)
+{
+    unsigned long generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(vec->mutex);
+            vec->start_cv.wait(lock, [vec, generation]() { return vec->generation != generation; });
+            generation = vec->generation;
+
+            if (vec->command == Command_Quit)
+                return;
+        }
+
+        run_command(vec, thread);
+
+        std::lock_guard<std::mutex> lock(vec->mutex);
+
+        if (--vec->pending == 0)
+            vec->done_cv.notify_one();
+    }
+}
+
+static void run_command(gs_vec_env* vec, int thread)
+{
+    int count = static_cast<int>(vec->envs.size());
+
+    // Contiguous blocks, the same instances always go to the same thread
+    int begin = (count * thread) / vec->thread_count;
+    int end = (count * (thread + 1)) / vec->thread_count;
+
+    for (int i = begin; i < end; i++)
+    {
+        switch (vec->command)
+        {
+            case Command_Create:
+                if (!IsValidPointer(vec->envs[i]))
+                    vec->envs[i] = gs_env_create(vec->rom_path.c_str(), &vec->config);
+                break;
+            case Command_Attach:
+                gs_env_set_obs_buffer(vec->envs[i], vec->obs + (vec->obs_size * i));
+                break;
+            case Command_Reset:
+                gs_env_reset(vec->envs[i]);
+                break;
+            case Command_Step:
+                gs_env_step(vec->envs[i], vec->actions[i], vec->frameskip);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void dispatch(gs_vec_env* vec, vec_Command command)
+{
+    {
+        std::lock_guard<std::mutex> lock(vec->mutex);
+        vec->command = command;
+        vec->pending = vec->thread_count - 1;
+        vec->generation++;
+    }
+
+    vec->start_cv.notify_all();
+
+    run_command(vec, 0);
+
+    std::unique_lock<std::mutex> lock(vec->mutex);
+    vec->done_cv.wait(lock, [vec]() { return vec->pending == 0; });
+}
@@ -0,0 +1,175 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include "../../src/definitions.h"
+#include "../../src/opcode_names.h"
+#include "../../src/Tracer.h"
+
+static void print_usage(const char* program);
+static void print_record(FILE* out, u64 clock, const Tracer::Record& record, const Tracer::Record* next, bool delta);
+static void print_register(FILE* out, const char* name, u16 before, u16 after, bool delta);
+
+int main(int argc, char* argv[])
+{
+    bool delta = false;
+    const char* input_path = NULL;
+    const char* output_path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-d") == 0)
+            delta = true;
+        else if (!IsValidPointer(input_path))
+            input_path = argv[i];
+        else if (!IsValidPointer(output_path))
+            output_path = argv[i];
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!IsValidPointer(input_path))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(input_path, "rb");
+
+    if (!IsValidPointer(in))
+    {
+        fprintf(stderr, "Unable to open %s\n", input_path);
+        return 1;
+    }
+
+    Tracer::FileHeader header;
+
+    if ((fread(&header, sizeof(header), 1, in) != 1) || (memcmp(header.magic, GS_TRACE_MAGIC, sizeof(header.magic)) != 0) || (header.record_size != sizeof(Tracer::Record)))
+    {
+        fprintf(stderr, "%s is not a Gearsystem trace\n", input_path);
+        fclose(in);
+        return 1;
+    }
+
+    FILE* out = IsValidPointer(output_path) ? fopen(output_path, "w") : stdout;
+
+    if (!IsValidPointer(out))
+    {
+        fprintf(stderr, "Unable to create %s\n", output_path);
+        fclose(in);
+        return 1;
+    }
+
+    // Each line needs the next record, it holds the registers after the step
+    Tracer::Record current;
+    Tracer::Record next;
+    u64 clock = header.clock;
+    bool has_current = (header.count > 0) && (fread(&current, sizeof(current), 1, in) == 1);
+
+    for (u32 i = 1; has_current; i++)
+    {
+        bool has_next = (i < header.count) && (fread(&next, sizeof(next), 1, in) == 1);
+
+        print_record(out, clock, current, has_next ? &next : NULL, delta);
+
+        clock += current.tstates;
+
+        current = next;
+        has_current = has_next;
+    }
+
+    fclose(in);
+
+    if (out != stdout)
+        fclose(out);
+
+    return 0;
+}
+
+static void print_usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [-d] trace_file [output_file]\n", program);
+    fprintf(stderr, "  -d  show only the registers each instruction changes\n");
+}
+
+static void print_record(FILE* out, u64 clock, const Tracer::Record& record, const Tracer::Record* next, bool delta)
+{
+    fprintf(out, "%12llu  ", (unsigned long long)clock);
+
+    if (record.bank == 0xFF)
+        fprintf(out, "--:%04X  ", record.pc);
+    else
+        fprintf(out, "%02X:%04X  ", record.bank, record.pc);
+
+    if (record.type == Tracer::RecordINT)
+        fprintf(out, "%-12s  %-20s", "", "*** INT ***");
+    else if (record.type == Tracer::RecordNMI)
+        fprintf(out, "%-12s  %-20s", "", "*** NMI ***");
+    else
+    {
+        // Four bytes are enough for any instruction, the rest is padding
+        u8 bytes[12] = { 0 };
+        memcpy(bytes, record.bytes, sizeof(record.bytes));
+
+        char name[64];
+        char hex[16] = "";
+        int size = FormatOPCode(bytes, record.pc, name);
+
+        for (int i = 0; (i < size) && (i < 4); i++)
+            sprintf(hex + (i * 3), "%02X ", bytes[i]);
+
+        fprintf(out, "%-12s  %-20s", hex, name);
+    }
+
+    if (delta)
+    {
+        if (IsValidPointer(next))
+        {
+            print_register(out, "AF", record.af, next->af, true);
+            print_register(out, "BC", record.bc, next->bc, true);
+            print_register(out, "DE", record.de, next->de, true);
+            print_register(out, "HL", record.hl, next->hl, true);
+            print_register(out, "IX", record.ix, next->ix, true);
+            print_register(out, "IY", record.iy, next->iy, true);
+            print_register(out, "SP", record.sp, next->sp, true);
+        }
+    }
+    else
+    {
+        print_register(out, "AF", record.af, record.af, false);
+        print_register(out, "BC", record.bc, record.bc, false);
+        print_register(out, "DE", record.de, record.de, false);
+        print_register(out, "HL", record.hl, record.hl, false);
+        print_register(out, "IX", record.ix, record.ix, false);
+        print_register(out, "IY", record.iy, record.iy, false);
+        print_register(out, "SP", record.sp, record.sp, false);
+    }
+
+    fprintf(out, " (%d)\n", record.tstates);
+}
+
+static void print_register(FILE* out, const char* name, u16 before, u16 after, bool delta)
+{
+    if (!delta)
+        fprintf(out, " %s=%04X", name, before);
+    else if (before != after)
+        fprintf(out, " %s=%04X", name, after);
+}
@@ -117,3 +117,12 @@ void Audio::LoadState(std::istream& stream)
     m_pApu->reset();
     m_pBuffer->clear();
 }
+
+void Audio::CopyState(const Audio* pSource)
+{
+    // The APU has not written deltas past the elapsed cycles of each side
+    m_pBuffer->copy_state(*pSource->m_pBuffer, pSource->m_ElapsedCycles, m_ElapsedCycles);
+    m_pApu->copy_state(*pSource->m_pApu);
+
+    m_ElapsedCycles = pSource->m_ElapsedCycles;
+}
@@ -18,11 +18,143 @@
  */
 
 #include <string>
+#include <vector>
 #include <algorithm>
 #include <ctype.h>
 #include "Cartridge.h"
 #include "miniz/miniz.c"
 #include "game_db.h"
+#include "crc32.h"
+
+static bool CompareDatabaseEntries(const GS_GameDBEntry& a, const GS_GameDBEntry& b)
+{
+    return a.crc < b.crc;
+}
+
+static std::vector<GS_GameDBEntry> BuildDatabaseIndex()
+{
+    std::vector<GS_GameDBEntry> index;
+
+    for (int i = 0; kGameDatabase[i].title != 0; i++)
+        index.push_back(kGameDatabase[i]);
+
+    std::stable_sort(index.begin(), index.end(), CompareDatabaseEntries);
+
+    return index;
+}
+
+static std::vector<GS_GameDBEntry>& GetDatabaseIndex()
+{
+    static std::vector<GS_GameDBEntry> index = BuildDatabaseIndex();
+    return index;
+}
+
+static const GS_GameDBEntry* FindInDatabase(u32 crc)
+{
+    std::vector<GS_GameDBEntry>& index = GetDatabaseIndex();
+    GS_GameDBEntry key;
+    key.crc = crc;
+
+    std::vector<GS_GameDBEntry>::const_iterator it = std::lower_bound(index.begin(), index.end(), key, CompareDatabaseEntries);
+
+    if ((it != index.end()) && (it->crc == crc))
+        return &(*it);
+
+    return NULL;
+}
+
+static std::string UnescapeXML(const std::string& text)
+{
+    static const char* const kEntities[][2] = {
+        {"&apos;", "'"}, {"&quot;", "\""}, {"&lt;", "<"}, {"&gt;", ">"}, {"&amp;", "&"}
+    };
+
+    std::string ret(text);
+
+    for (int i = 0; i < 5; i++)
+    {
+        size_t pos = 0;
+        size_t len = strlen(kEntities[i][0]);
+
+        while ((pos = ret.find(kEntities[i][0], pos)) != std::string::npos)
+        {
+            ret.replace(pos, len, kEntities[i][1]);
+            pos++;
+        }
+    }
+
+    return ret;
+}
+
+static const u16 kHeaderLocations[3] = {0x7FF0, 0x1FF0, 0x3FF0};
+
+struct ProbeStream
+{
+    u64 skip;
+    u64 end;
+    bool hash;
+    u32 crc;
+    u8 headers[3][16];
+};
+
+// Receives inflated ZIP data, keeps the header windows and optionally hashes
+static size_t ProbeStreamCallback(void* opaque, mz_uint64 file_ofs, const void* buf, size_t n)
+{
+    ProbeStream* stream = static_cast<ProbeStream*>(opaque);
+    const u8* data = static_cast<const u8*>(buf);
+    size_t skip = 0;
+
+    if (file_ofs < stream->skip)
+        skip = static_cast<size_t>(std::min<u64>(stream->skip - file_ofs, n));
+
+    // The whole chunk is copier header, there is no ROM data in it yet
+    if (skip == n)
+        return n;
+
+    u64 rom_ofs = file_ofs + skip - stream->skip;
+    size_t len = n - skip;
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int b = 0; b < 16; b++)
+        {
+            u64 pos = kHeaderLocations[i] + b;
+            if ((pos >= rom_ofs) && (pos < rom_ofs + len))
+                stream->headers[i][b] = data[skip + (pos - rom_ofs)];
+        }
+    }
+
+    if (stream->hash)
+        stream->crc = CalculateCRC32(stream->crc, data + skip, static_cast<int>(len));
+    else if (rom_ofs + len >= stream->end)
+        return 0;
+
+    return n;
+}
+
+static void AddDatabaseEntry(std::vector<GS_GameDBEntry>& entries, const char* crc_text, const std::string& title)
+{
+    // Titles live as long as the process, the index keeps raw pointers to them
+    static std::list<std::string> titles;
+
+    char* end = NULL;
+    unsigned long crc = strtoul(crc_text, &end, 16);
+
+    if (end == crc_text)
+        return;
+
+    titles.push_back(title);
+
+    GS_GameDBEntry entry;
+    entry.crc = static_cast<u32>(crc);
+    entry.mapper = GS_DB_DEFAULT_MAPPER;
+    entry.pal = false;
+    entry.sms_mode = false;
+    entry.no_battery = false;
+    entry.title = titles.back().c_str();
+
+    entries.push_back(entry);
+}
 
 Cartridge::Cartridge()
 {
@@ -40,6 +172,7 @@ Cartridge::Cartridge()
     m_bPAL = false;
     m_bRAMWithoutBattery = false;
     m_iCRC = 0;
+    m_szTitle = "";
 }
 
 Cartridge::~Cartridge()
@@ -69,6 +202,7 @@ void Cartridge::Reset()
     m_bRAMWithoutBattery = false;
     m_GameGenieList.clear();
     m_iCRC = 0;
+    m_szTitle = "";
 }
 
 u32 Cartridge::GetCRC() const
@@ -122,7 +256,6 @@ void Cartridge::ForceConfig(Cartridge::ForceConfiguration config)
     m_bGameGear = (extension == "gg");
     m_bSG1000 = (extension == "sg" || extension == "mv");
 
-    m_iCRC = CalculateCRC32(0, m_pROM, m_iROMSize);
     GatherMetadata(m_iCRC);
 
     if (config.region == CartridgePAL)
@@ -233,28 +366,51 @@ u8* Cartridge::GetROM() const
     return m_pROM;
 }
 
-bool Cartridge::LoadFromZipFile(const u8* buffer, int size)
+static bool OpenZipArchive(const char* path, mz_zip_archive* zip_archive, std::vector<char>& archive)
 {
     using namespace std;
 
-    mz_zip_archive zip_archive;
     mz_bool status;
-    memset(&zip_archive, 0, sizeof (zip_archive));
+    memset(zip_archive, 0, sizeof (*zip_archive));
 
-    status = mz_zip_reader_init_mem(&zip_archive, (void*) buffer, size, 0);
-    if (!status)
+#ifndef MINIZ_NO_STDIO
+    // Only the central directory is read here, entries are visited by index
+    (void)archive;
+    status = mz_zip_reader_init_file(zip_archive, path, MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY);
+#else
+    ifstream file(path, ios::in | ios::binary | ios::ate);
+
+    if (file.is_open())
     {
-        Log("mz_zip_reader_init_mem() failed!");
-        return false;
+        archive.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, ios::beg);
+        file.read(archive.data(), archive.size());
+        file.close();
     }
 
-    for (unsigned int i = 0; i < mz_zip_reader_get_num_files(&zip_archive); i++)
+    status = !archive.empty() && mz_zip_reader_init_mem(zip_archive, archive.data(), archive.size(), MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY);
+#endif
+    if (!status)
+        Log_Error("Unable to open ZIP archive %s", path);
+
+    return status != 0;
+}
+
+// ROM entries of an open archive, straight from its central directory
+static bool ListZipEntries(mz_zip_archive* zip_archive, std::vector<Cartridge::ZipEntry>& entries)
+{
+    using namespace std;
+
+    entries.clear();
+    mz_uint file_count = mz_zip_reader_get_num_files(zip_archive);
+
+    for (mz_uint i = 0; i < file_count; i++)
     {
         mz_zip_archive_file_stat file_stat;
-        if (!mz_zip_reader_file_stat(&zip_archive, i, &file_stat))
+        if (!mz_zip_reader_file_stat(zip_archive, i, &file_stat))
         {
-            Log("mz_zip_reader_file_stat() failed!");
-            mz_zip_reader_end(&zip_archive);
+            Log_Error("mz_zip_reader_file_stat() failed!");
+            entries.clear();
             return false;
         }
 
@@ -266,32 +422,88 @@ bool Cartridge::LoadFromZipFile(const u8* buffer, int size)
 
         if ((extension == "sms") || (extension == "gg") || (extension == "sg") || (extension == "mv"))
         {
-            m_bGameGear = (extension == "gg");
-            m_bSG1000 = (extension == "sg" || extension == "mv");
+            Cartridge::ZipEntry entry;
+            entry.name = file_stat.m_filename;
+            entry.file_index = i;
+            entry.crc = file_stat.m_crc32;
+            entry.size = static_cast<int>(file_stat.m_uncomp_size);
+            entries.push_back(entry);
+        }
+    }
 
-            void *p;
-            size_t uncomp_size;
+    return true;
+}
 
-            p = mz_zip_reader_extract_file_to_heap(&zip_archive, file_stat.m_filename, &uncomp_size, 0);
-            if (!p)
-            {
-                Log("mz_zip_reader_extract_file_to_heap() failed!");
-                mz_zip_reader_end(&zip_archive);
-                return false;
-            }
+// A negative entry loads the first ROM in the archive, entries count ROMs only
+bool Cartridge::LoadFromZipFile(const char* path, int zipEntry)
+{
+    using namespace std;
 
-            bool ok = LoadFromBuffer((const u8*) p, (int)uncomp_size);
+    mz_zip_archive zip_archive;
+    std::vector<char> archive;
+    std::vector<ZipEntry> entries;
 
-            free(p);
-            mz_zip_reader_end(&zip_archive);
+    if (!OpenZipArchive(path, &zip_archive, archive))
+        return false;
 
-            return ok;
-        }
+    if (!ListZipEntries(&zip_archive, entries) || (zipEntry >= static_cast<int>(entries.size())) || entries.empty())
+    {
+        Log_Error("ROM entry %d not found in ZIP archive %s", zipEntry, path);
+        mz_zip_reader_end(&zip_archive);
+        return false;
     }
-    return false;
+
+    const ZipEntry& entry = entries[(zipEntry < 0) ? 0 : zipEntry];
+
+    // A ROM chosen out of a multi-ROM archive keeps its own save files
+    if (zipEntry >= 0)
+    {
+        string name = entry.name.substr(entry.name.find_last_of("/\\") + 1);
+        snprintf(m_szFileName, sizeof(m_szFileName), "%s", name.c_str());
+    }
+
+    string fn(entry.name);
+    transform(fn.begin(), fn.end(), fn.begin(), (int(*)(int)) tolower);
+    string extension = fn.substr(fn.find_last_of(".") + 1);
+
+    m_bGameGear = (extension == "gg");
+    m_bSG1000 = (extension == "sg" || extension == "mv");
+
+    int size = entry.size;
+    int header = GetROMHeaderSize(size);
+
+    if (header < 0)
+    {
+        mz_zip_reader_end(&zip_archive);
+        return false;
+    }
+
+    // Inflate straight into the ROM allocation, no intermediate heap copy
+    m_pROM = new u8[size];
+
+    if (!mz_zip_reader_extract_to_mem(&zip_archive, entry.file_index, m_pROM, size, 0))
+    {
+        Log_Error("mz_zip_reader_extract_to_mem() failed!");
+        mz_zip_reader_end(&zip_archive);
+        SafeDeleteArray(m_pROM);
+        return false;
+    }
+
+    mz_zip_reader_end(&zip_archive);
+
+    if (header > 0)
+        memmove(m_pROM, m_pROM + header, size - header);
+
+    m_iROMSize = size - header;
+
+    // The archive already stores the CRC and miniz has verified it while inflating
+    if (header == 0)
+        return IdentifyROM(entry.crc);
+    else
+        return IdentifyROM(CalculateCRC32(0, m_pROM, m_iROMSize));
 }
 
-bool Cartridge::LoadFromFile(const char* path)
+bool Cartridge::LoadFromFile(const char* path, int zipEntry)
 {
     using namespace std;
 
@@ -324,51 +536,53 @@ bool Cartridge::LoadFromFile(const char* path)
 
     strcpy(m_szFileName, filename.c_str());
 
-    ifstream file(path, ios::in | ios::binary | ios::ate);
+    string fn(path);
+    transform(fn.begin(), fn.end(), fn.begin(), (int(*)(int)) tolower);
+    string extension = fn.substr(fn.find_last_of(".") + 1);
 
-    if (file.is_open())
+    if (extension == "zip")
     {
-        int size = static_cast<int> (file.tellg());
-        char* memblock = new char[size];
-        file.seekg(0, ios::beg);
-        file.read(memblock, size);
-        file.close();
-
-        string fn(path);
-        transform(fn.begin(), fn.end(), fn.begin(), (int(*)(int)) tolower);
-        string extension = fn.substr(fn.find_last_of(".") + 1);
+        Log("Loading from ZIP...");
+        m_bReady = LoadFromZipFile(path, zipEntry);
+    }
+    else
+    {
+        ifstream file(path, ios::in | ios::binary | ios::ate);
 
-        if (extension == "zip")
-        {
-            Log("Loading from ZIP...");
-            m_bReady = LoadFromZipFile(reinterpret_cast<u8*> (memblock), size);
-        }
-        else
+        if (file.is_open())
         {
-            m_bGameGear = (extension == "gg");
-            m_bSG1000= (extension == "sg" || extension == "mv");
-            m_bReady = LoadFromBuffer(reinterpret_cast<u8*> (memblock), size);
-        }
+            int size = static_cast<int> (file.tellg());
+            int header = GetROMHeaderSize(size);
 
-        if (m_bReady)
-        {
-            Log("ROM loaded", path);
+            if (header >= 0)
+            {
+                m_bGameGear = (extension == "gg");
+                m_bSG1000= (extension == "sg" || extension == "mv");
+
+                // Read straight into the ROM allocation, skipping any copier header
+                m_iROMSize = size - header;
+                m_pROM = new u8[m_iROMSize];
+                file.seekg(header, ios::beg);
+                file.read(reinterpret_cast<char*> (m_pROM), m_iROMSize);
+
+                m_bReady = !file.fail() && IdentifyROM(CalculateCRC32(0, m_pROM, m_iROMSize));
+            }
+
+            file.close();
         }
         else
         {
-            Log("There was a problem loading the memory for file %s...", path);
+            Log_Error("There was a problem loading the file %s...", path);
         }
-
-        SafeDeleteArray(memblock);
     }
-    else
+
+    if (m_bReady)
     {
-        Log("There was a problem loading the file %s...", path);
-        m_bReady = false;
+        Log("ROM loaded", path);
     }
-
-    if (!m_bReady)
+    else
     {
+        Log_Error("There was a problem loading the memory for file %s...", path);
         Reset();
     }
 
@@ -380,34 +594,48 @@ bool Cartridge::LoadFromBuffer(const u8* buffer, int size)
     if (IsValidPointer(buffer))
     {
         Log("Loading from buffer... Size: %d", size);
-        // Some ROMs have 512 Byte File Headers
-        if ((size % 1024) == 512)
-        {
-            buffer += 512;
-            size -= 512;
-            Log("Invalid size found. ROM trimmed to %d bytes", size);
-        }
-        // Unkown size
-        else if ((size % 1024) != 0)
-        {
-            Log("Invalid size found. %d bytes", size);
-            return false;
-        }
 
-        m_iROMSize = size;
-        m_pROM = new u8[m_iROMSize];
-        memcpy(m_pROM, buffer, m_iROMSize);
+        int header = GetROMHeaderSize(size);
 
-        m_bReady = true;
+        if (header < 0)
+            return false;
 
-        m_iCRC = CalculateCRC32(0, m_pROM, m_iROMSize);
+        m_iROMSize = size - header;
+        m_pROM = new u8[m_iROMSize];
+        memcpy(m_pROM, buffer + header, m_iROMSize);
 
-        return GatherMetadata(m_iCRC);
+        return IdentifyROM(CalculateCRC32(0, m_pROM, m_iROMSize));
     }
     else
         return false;
 }
 
+int Cartridge::GetROMHeaderSize(int size)
+{
+    // Some ROMs have 512 Byte File Headers
+    if ((size % 1024) == 512)
+    {
+        Log_Warning("Invalid size found. ROM trimmed to %d bytes", size - 512);
+        return 512;
+    }
+    // Unkown size
+    else if ((size % 1024) != 0)
+    {
+        Log_Warning("Invalid size found. %d bytes", size);
+        return -1;
+    }
+
+    return 0;
+}
+
+bool Cartridge::IdentifyROM(u32 crc)
+{
+    m_bReady = true;
+    m_iCRC = crc;
+
+    return GatherMetadata(m_iCRC);
+}
+
 unsigned int Cartridge::Pow2Ceil(u16 n)
 {
     --n;
@@ -465,7 +693,7 @@ bool Cartridge::GatherMetadata(u32 crc)
     }
     else
     {
-        Log("ROM is NOT Valid. No header found");
+        Log_Warning("ROM is NOT Valid. No header found");
 
         zone = 3;
     }
@@ -548,10 +776,10 @@ bool Cartridge::GatherMetadata(u32 crc)
             Log("Korean mapper found");
             break;
         case Cartridge::CartridgeNotSupported:
-            Log("Cartridge not supported!!");
+            Log_Error("Cartridge not supported!!");
             break;
         default:
-            Log("ERROR with cartridge type!!");
+            Log_Error("ERROR with cartridge type!!");
             break;
     }
 
@@ -570,61 +798,378 @@ bool Cartridge::GatherMetadata(u32 crc)
 
 void Cartridge::GetInfoFromDB(u32 crc)
 {
-    int i = 0;
-    bool found = false;
+    m_szTitle = "";
+
+    const GS_GameDBEntry* entry = FindInDatabase(crc);
+
+    if (!IsValidPointer(entry))
+    {
+        Log("ROM not found in database. CRC: %X", crc);
+        return;
+    }
+
+    Log("ROM found in database: %s. CRC: %X", entry->title, crc);
+
+    m_szTitle = entry->title;
+
+    if (entry->mapper == GS_DB_CODEMASTERS_MAPPER)
+        m_Type = Cartridge::CartridgeCodemastersMapper;
+    else if (entry->mapper == GS_DB_SG1000_MAPPER)
+    {
+        m_bSG1000 = true;
+        m_Type = Cartridge::CartridgeSG1000Mapper;
+    }
+    else if (entry->mapper == GS_DB_KOREAN_MAPPER)
+    {
+        m_Type = Cartridge::CartridgeKoreanMapper;
+    }
+    else if (entry->mapper == GS_DB_MSX_MAPPER)
+    {
+        m_Type = Cartridge::CartridgeMSXMapper;
+    }
+
+    if (entry->sms_mode)
+    {
+        Log("Forcing Master System mode");
+        m_bGameGear = false;
+    }
+
+    if (entry->pal)
+    {
+        Log("PAL cartridge: Running at 50Hz");
+        m_bPAL = true;
+    }
+
+    if (entry->no_battery)
+    {
+        Log("Cartridge with SRAM but no battery");
+        m_bRAMWithoutBattery = true;
+    }
+}
+
+const char* Cartridge::GetTitle() const
+{
+    return m_szTitle;
+}
+
+// Not thread safe, load external databases before any ROM is identified
+bool Cartridge::LoadDatabase(const char* path)
+{
+    using namespace std;
+
+    ifstream file(path, ios::in);
 
-    while(!found && (kGameDatabase[i].title != 0))
+    if (!file.is_open())
     {
-        u32 db_crc = kGameDatabase[i].crc;
+        Log_Error("Unable to open game database %s", path);
+        return false;
+    }
+
+    std::vector<GS_GameDBEntry>& index = GetDatabaseIndex();
+    std::vector<GS_GameDBEntry> entries;
+    std::string line;
+    std::string title;
+
+    // Accepts both Logiqx XML and ClrMamePro DAT files, one tag per line
+    while (getline(file, line))
+    {
+        size_t pos;
 
-        if (db_crc == crc)
+        if ((pos = line.find("<game name=\"")) != std::string::npos)
+        {
+            size_t end = line.find('"', pos + 12);
+            title = UnescapeXML(line.substr(pos + 12, end - pos - 12));
+        }
+        else if ((pos = line.find("<rom ")) != std::string::npos)
+        {
+            size_t crc_pos = line.find("crc=\"", pos);
+            if (crc_pos != std::string::npos)
+                AddDatabaseEntry(entries, line.c_str() + crc_pos + 5, title);
+        }
+        else if ((pos = line.find("rom (")) != std::string::npos)
+        {
+            size_t crc_pos = line.find(" crc ", pos);
+            if (crc_pos != std::string::npos)
+                AddDatabaseEntry(entries, line.c_str() + crc_pos + 5, title);
+        }
+        else if (((pos = line.find_first_not_of(" \t")) != std::string::npos) && (line.compare(pos, 6, "name \"") == 0))
         {
-            found = true;
+            size_t end = line.find('"', pos + 6);
+            title = line.substr(pos + 6, end - pos - 6);
+        }
+    }
 
-            Log("ROM found in database: %s. CRC: %X", kGameDatabase[i].title, crc);
+    // Built-in entries carry hardware quirks, keep them on CRC collisions.
+    // Only the entries already in the index are searched, it stays sorted
+    // until the merge. Repeated CRCs in the file keep their first entry
+    std::stable_sort(entries.begin(), entries.end(), CompareDatabaseEntries);
 
-            if (kGameDatabase[i].mapper == GS_DB_CODEMASTERS_MAPPER)
-                m_Type = Cartridge::CartridgeCodemastersMapper;
-            else if (kGameDatabase[i].mapper == GS_DB_SG1000_MAPPER)
-            {
-                m_bSG1000 = true;
-                m_Type = Cartridge::CartridgeSG1000Mapper;
-            }
-            else if (kGameDatabase[i].mapper == GS_DB_KOREAN_MAPPER)
-            {
-                m_Type = Cartridge::CartridgeKoreanMapper;
-            }
-            else if (kGameDatabase[i].mapper == GS_DB_MSX_MAPPER)
-            {
-                m_Type = Cartridge::CartridgeMSXMapper;
-            }
+    size_t sorted = index.size();
+    size_t added = 0;
 
-            if (kGameDatabase[i].sms_mode)
-            {
-                Log("Forcing Master System mode");
-                m_bGameGear = false;
-            }
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if ((i > 0) && (entries[i].crc == entries[i - 1].crc))
+            continue;
 
-            if (kGameDatabase[i].pal)
-            {
-                Log("PAL cartridge: Running at 50Hz");
-                m_bPAL = true;
-            }
+        if (!std::binary_search(index.begin(), index.begin() + sorted, entries[i], CompareDatabaseEntries))
+        {
+            index.push_back(entries[i]);
+            added++;
+        }
+    }
 
-            if (kGameDatabase[i].no_battery)
-            {
-                Log("Cartridge with SRAM but no battery");
-                m_bRAMWithoutBattery = true;
-            }
+    std::inplace_merge(index.begin(), index.begin() + sorted, index.end(), CompareDatabaseEntries);
+
+    Log("Game database %s loaded: %d new entries, %d total", path, (int)added, (int)index.size());
+
+    return true;
+}
+
+int Cartridge::GetDatabaseSize()
+{
+    return static_cast<int>(GetDatabaseIndex().size());
+}
+
+static void ResetProbeResult(Cartridge::ProbeResult& result)
+{
+    result.type = Cartridge::CartridgeNotSupported;
+    result.zone = Cartridge::CartridgeUnknownZone;
+    result.region = Cartridge::CartridgeUnknownRegion;
+    result.system = Cartridge::CartridgeUnknownSystem;
+    result.rom_size = 0;
+    result.valid_header = false;
+    result.has_crc = false;
+    result.crc = 0;
+    result.title = "";
+}
+
+// Inflates the start of one archive entry for its header windows
+static void ProbeZipEntry(mz_zip_archive* zip_archive, const Cartridge::ZipEntry& entry, bool calculate_crc, ProbeStream& stream, Cartridge::ProbeResult& result)
+{
+    int header = ((entry.size % 1024) == 512) ? 512 : 0;
+
+    // The directory CRC is free unless a copier header has to be dropped
+    bool inflate_all = calculate_crc && (header > 0);
+
+    memset(&stream, 0, sizeof(stream));
+    stream.skip = header;
+    stream.end = 0x8000;
+    stream.hash = inflate_all;
+
+    mz_zip_reader_extract_to_callback(zip_archive, entry.file_index, ProbeStreamCallback, &stream, 0);
+
+    if (header == 0)
+    {
+        result.has_crc = true;
+        result.crc = entry.crc;
+    }
+    else if (inflate_all)
+    {
+        result.has_crc = true;
+        result.crc = stream.crc;
+    }
+}
+
+static std::string GetExtension(const std::string& path)
+{
+    std::string fn(path);
+    std::transform(fn.begin(), fn.end(), fn.begin(), (int(*)(int)) tolower);
+    return fn.substr(fn.find_last_of(".") + 1);
+}
+
+bool Cartridge::Probe(const char* path, ProbeResult& result, bool calculate_crc)
+{
+    using namespace std;
+
+    ResetProbeResult(result);
+
+    string extension = GetExtension(path);
+
+    ProbeStream stream;
+
+    // Archives are probed through their first ROM
+    if (extension == "zip")
+    {
+#ifdef MINIZ_NO_STDIO
+        return false;
+#else
+        mz_zip_archive zip_archive;
+        memset(&zip_archive, 0, sizeof (zip_archive));
+        vector<ZipEntry> entries;
+
+        if (!mz_zip_reader_init_file(&zip_archive, path, MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY))
+            return false;
+
+        if (ListZipEntries(&zip_archive, entries) && !entries.empty())
+            ProbeZipEntry(&zip_archive, entries[0], calculate_crc, stream, result);
+
+        mz_zip_reader_end(&zip_archive);
+
+        if (entries.empty())
+            return false;
+
+        return ProbeMetadata(GetExtension(entries[0].name), entries[0].size, stream.headers, result);
+#endif
+    }
+
+    memset(&stream, 0, sizeof(stream));
+
+    ifstream file(path, ios::in | ios::binary | ios::ate);
+
+    if (!file.is_open())
+        return false;
+
+    int size = static_cast<int>(file.tellg());
+    int header = ((size % 1024) == 512) ? 512 : 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (header + kHeaderLocations[i] + 16 <= size)
+        {
+            file.seekg(header + kHeaderLocations[i], ios::beg);
+            file.read(reinterpret_cast<char*>(stream.headers[i]), 16);
         }
-        else
-            i++;
     }
 
-    if (!found)
+    if (calculate_crc)
     {
-        Log("ROM not found in database. CRC: %X", crc);
+        char chunk[0x4000];
+        u32 crc = 0;
+        file.clear();
+        file.seekg(header, ios::beg);
+
+        while (file.read(chunk, sizeof(chunk)) || (file.gcount() > 0))
+            crc = CalculateCRC32(crc, reinterpret_cast<u8*>(chunk), static_cast<int>(file.gcount()));
+
+        result.has_crc = true;
+        result.crc = crc;
+    }
+
+    file.close();
+
+    return ProbeMetadata(extension, size, stream.headers, result);
+}
+
+// One result per ROM in the archive, in the order LoadFromFile() numbers
+// them. Entries that are not valid ROM images have a rom_size of 0
+bool Cartridge::ProbeZip(const char* path, std::vector<ZipEntry>& entries, std::vector<ProbeResult>& results, bool calculate_crc)
+{
+    entries.clear();
+    results.clear();
+
+#ifdef MINIZ_NO_STDIO
+    return false;
+#else
+    mz_zip_archive zip_archive;
+    memset(&zip_archive, 0, sizeof (zip_archive));
+
+    if (!mz_zip_reader_init_file(&zip_archive, path, MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY))
+        return false;
+
+    ListZipEntries(&zip_archive, entries);
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        ProbeStream stream;
+        ProbeResult result;
+
+        ResetProbeResult(result);
+        ProbeZipEntry(&zip_archive, entries[i], calculate_crc, stream, result);
+
+        if (!ProbeMetadata(GetExtension(entries[i].name), entries[i].size, stream.headers, result))
+            ResetProbeResult(result);
+
+        results.push_back(result);
+    }
+
+    mz_zip_reader_end(&zip_archive);
+
+    return !entries.empty();
+#endif
+}
+
+// Same rules as GatherMetadata, applied to the header windows only
+bool Cartridge::ProbeMetadata(const std::string& extension, int size, const u8 headers[3][16], ProbeResult& result)
+{
+    if ((size % 1024) == 512)
+        size -= 512;
+    else if ((size % 1024) != 0)
+        return false;
+
+    result.rom_size = size;
+
+    u8 zone = 3;
+
+    for (int i = 0; i < 3; i++)
+    {
+        if ((kHeaderLocations[i] + 0x10 <= size) && (memcmp(headers[i], "TMR SEGA", 8) == 0))
+        {
+            result.valid_header = true;
+            zone = (headers[i][0x0F] >> 4) & 0x0F;
+            break;
+        }
     }
+
+    bool game_gear = (extension == "gg");
+    bool sg1000 = (extension == "sg" || extension == "mv");
+    bool pal = false;
+
+    switch (zone)
+    {
+        case 3:
+            result.zone = CartridgeJapanSMS;
+            break;
+        case 4:
+            result.zone = CartridgeExportSMS;
+            break;
+        case 5:
+            result.zone = CartridgeJapanGG;
+            game_gear = true;
+            break;
+        case 6:
+            result.zone = CartridgeExportGG;
+            game_gear = true;
+            break;
+        case 7:
+            result.zone = CartridgeInternationalGG;
+            game_gear = true;
+            break;
+        default:
+            result.zone = CartridgeUnknownZone;
+            break;
+    }
+
+    result.type = (size <= 0xC000) ? CartridgeRomOnlyMapper : CartridgeSegaMapper;
+
+    const GS_GameDBEntry* entry = result.has_crc ? FindInDatabase(result.crc) : NULL;
+
+    if (IsValidPointer(entry))
+    {
+        result.title = entry->title;
+
+        if (entry->mapper == GS_DB_CODEMASTERS_MAPPER)
+            result.type = CartridgeCodemastersMapper;
+        else if (entry->mapper == GS_DB_SG1000_MAPPER)
+        {
+            sg1000 = true;
+            result.type = CartridgeSG1000Mapper;
+        }
+        else if (entry->mapper == GS_DB_KOREAN_MAPPER)
+            result.type = CartridgeKoreanMapper;
+        else if (entry->mapper == GS_DB_MSX_MAPPER)
+            result.type = CartridgeMSXMapper;
+
+        if (entry->sms_mode)
+            game_gear = false;
+
+        pal = entry->pal;
+    }
+
+    result.system = game_gear ? CartridgeGG : (sg1000 ? CartridgeSG1000 : CartridgeSMS);
+    result.region = result.has_crc ? (pal ? CartridgePAL : CartridgeNTSC) : CartridgeUnknownRegion;
+
+    return true;
 }
 
 void Cartridge::SetGameGenieCheat(const char* szCheat)
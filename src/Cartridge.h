@@ -21,6 +21,8 @@
 #define	CARTRIDGE_H
 
 #include <list>
+#include <string>
+#include <vector>
 #include "definitions.h"
 
 class Cartridge
@@ -70,6 +72,27 @@ public:
         CartridgeSystem system;
     };
 
+    struct ProbeResult
+    {
+        CartridgeTypes type;
+        CartridgeZones zone;
+        CartridgeRegions region;
+        CartridgeSystem system;
+        int rom_size;
+        bool valid_header;
+        bool has_crc;
+        u32 crc;
+        const char* title;
+    };
+
+    struct ZipEntry
+    {
+        std::string name;
+        unsigned int file_index;
+        u32 crc;
+        int size;
+    };
+
 public:
     Cartridge();
     ~Cartridge();
@@ -90,16 +113,24 @@ public:
     const char* GetFilePath() const;
     const char* GetFileName() const;
     u8* GetROM() const;
-    bool LoadFromFile(const char* path);
+    bool LoadFromFile(const char* path, int zipEntry = -1);
     bool LoadFromBuffer(const u8* buffer, int size);
     void SetGameGenieCheat(const char* szCheat);
     void ClearGameGenieCheats();
+    const char* GetTitle() const;
+    static bool LoadDatabase(const char* path);
+    static int GetDatabaseSize();
+    static bool Probe(const char* path, ProbeResult& result, bool calculate_crc = false);
+    static bool ProbeZip(const char* path, std::vector<ZipEntry>& entries, std::vector<ProbeResult>& results, bool calculate_crc = false);
 
 private:
     unsigned int Pow2Ceil(u16 n);
     bool GatherMetadata(u32 crc);
     void GetInfoFromDB(u32 crc);
-    bool LoadFromZipFile(const u8* buffer, int size);
+    bool LoadFromZipFile(const char* path, int zipEntry);
+    static bool ProbeMetadata(const std::string& extension, int size, const u8 headers[3][16], ProbeResult& result);
+    int GetROMHeaderSize(int size);
+    bool IdentifyROM(u32 crc);
     bool TestValidROM(u16 location);
 
 private:
@@ -117,6 +148,7 @@ private:
     bool m_bPAL;
     bool m_bRAMWithoutBattery;
     u32 m_iCRC;
+    const char* m_szTitle;
 
     struct GameGenieCode
     {
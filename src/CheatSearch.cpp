@@ -0,0 +1,323 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <algorithm>
+#include <stdio.h>
+#include "CheatSearch.h"
+#include "Memory.h"
+#include "Cartridge.h"
+
+// Filters run over the whole search space without branches so the
+// compiler can vectorize them, a candidate is a byte set to 1
+struct CheatCompareEqual
+{
+    static u8 Test(u8 current, u8 other, u8) { return current == other; }
+};
+
+struct CheatCompareNotEqual
+{
+    static u8 Test(u8 current, u8 other, u8) { return current != other; }
+};
+
+struct CheatCompareGreater
+{
+    static u8 Test(u8 current, u8 other, u8) { return current > other; }
+};
+
+struct CheatCompareLess
+{
+    static u8 Test(u8 current, u8 other, u8) { return current < other; }
+};
+
+struct CheatCompareIncreasedBy
+{
+    static u8 Test(u8 current, u8 other, u8 n) { return static_cast<u8>(current - other) == n; }
+};
+
+struct CheatCompareDecreasedBy
+{
+    static u8 Test(u8 current, u8 other, u8 n) { return static_cast<u8>(other - current) == n; }
+};
+
+template <typename Compare>
+static int CheatFilter(const u8* current, const u8* other, u8 n, u8* candidates, int size)
+{
+    int count = 0;
+
+    for (int i = 0; i < size; i++)
+    {
+        candidates[i] &= Compare::Test(current[i], other[i], n);
+        count += candidates[i];
+    }
+
+    return count;
+}
+
+CheatSearch::CheatSearch(Memory* pMemory, Cartridge* pCartridge)
+{
+    m_pMemory = pMemory;
+    m_pCartridge = pCartridge;
+    InitPointer(m_pSnapshots);
+    InitPointer(m_pReference);
+    InitPointer(m_pOperand);
+    InitPointer(m_pCandidates);
+    m_iSize = 0;
+    m_iCartRAMSize = 0;
+    m_iPosition = 0;
+    m_iFrameCount = 0;
+    m_iCandidateCount = 0;
+}
+
+CheatSearch::~CheatSearch()
+{
+    Stop();
+}
+
+void CheatSearch::Start()
+{
+    Stop();
+
+    // Work RAM first, then the cartridge RAM that exists when the search starts
+    GetCartRAM(m_iCartRAMSize);
+
+    m_iSize = GS_CHEAT_SEARCH_WORK_RAM + m_iCartRAMSize;
+    m_pSnapshots = new u8[m_iSize * GS_CHEAT_SEARCH_FRAMES];
+    m_pReference = new u8[m_iSize];
+    m_pOperand = new u8[m_iSize];
+    m_pCandidates = new u8[m_iSize];
+    m_iPosition = 0;
+    m_iFrameCount = 0;
+
+    Capture();
+
+    memcpy(m_pReference, GetSnapshot(0), m_iSize);
+    memset(m_pCandidates, 1, m_iSize);
+    m_iCandidateCount = m_iSize;
+}
+
+void CheatSearch::Stop()
+{
+    SafeDeleteArray(m_pSnapshots);
+    SafeDeleteArray(m_pReference);
+    SafeDeleteArray(m_pOperand);
+    SafeDeleteArray(m_pCandidates);
+    m_iSize = 0;
+    m_iCartRAMSize = 0;
+    m_iFrameCount = 0;
+    m_iCandidateCount = 0;
+}
+
+void CheatSearch::Capture()
+{
+    if (!IsActive())
+        return;
+
+    u8* previous = (m_iFrameCount > 0) ? GetSnapshot(0) : NULL;
+
+    m_iPosition = (m_iPosition + 1) % GS_CHEAT_SEARCH_FRAMES;
+    m_iFrameCount = std::min(m_iFrameCount + 1, GS_CHEAT_SEARCH_FRAMES);
+
+    u8* snapshot = GetSnapshot(0);
+
+    memcpy(snapshot, m_pMemory->GetMemoryMap() + 0xC000, GS_CHEAT_SEARCH_WORK_RAM);
+
+    if (m_iCartRAMSize > 0)
+    {
+        // Cartridge RAM can be unmapped for a while, it keeps its last values
+        int size = 0;
+        u8* cart_ram = GetCartRAM(size);
+
+        if (IsValidPointer(cart_ram) && (size == m_iCartRAMSize))
+            memcpy(snapshot + GS_CHEAT_SEARCH_WORK_RAM, cart_ram, m_iCartRAMSize);
+        else if (IsValidPointer(previous))
+            memcpy(snapshot + GS_CHEAT_SEARCH_WORK_RAM, previous + GS_CHEAT_SEARCH_WORK_RAM, m_iCartRAMSize);
+        else
+            memset(snapshot + GS_CHEAT_SEARCH_WORK_RAM, 0, m_iCartRAMSize);
+    }
+}
+
+// Compares the last captured frame against the previous search, a frame
+// some frames ago or a value. Increased and decreased take the value as
+// the step and never compare against the value itself. Returns -1 and
+// keeps the candidates when that many frames have not been captured yet
+int CheatSearch::Filter(Relation relation, Operand operand, u8 value, int frames)
+{
+    if (!IsActive())
+        return 0;
+
+    const u8* current = GetSnapshot(0);
+    const u8* other = m_pReference;
+
+    if (operand == OperandFrames)
+    {
+        if ((frames < 1) || (frames >= m_iFrameCount))
+            return -1;
+
+        other = GetSnapshot(frames);
+    }
+    else if ((operand == OperandValue) && (relation != RelationIncreasedBy) && (relation != RelationDecreasedBy))
+    {
+        memset(m_pOperand, value, m_iSize);
+        other = m_pOperand;
+    }
+
+    switch (relation)
+    {
+        case RelationEqual:
+            m_iCandidateCount = CheatFilter<CheatCompareEqual>(current, other, value, m_pCandidates, m_iSize);
+            break;
+        case RelationNotEqual:
+            m_iCandidateCount = CheatFilter<CheatCompareNotEqual>(current, other, value, m_pCandidates, m_iSize);
+            break;
+        case RelationGreater:
+            m_iCandidateCount = CheatFilter<CheatCompareGreater>(current, other, value, m_pCandidates, m_iSize);
+            break;
+        case RelationLess:
+            m_iCandidateCount = CheatFilter<CheatCompareLess>(current, other, value, m_pCandidates, m_iSize);
+            break;
+        case RelationIncreasedBy:
+            m_iCandidateCount = CheatFilter<CheatCompareIncreasedBy>(current, other, value, m_pCandidates, m_iSize);
+            break;
+        case RelationDecreasedBy:
+            m_iCandidateCount = CheatFilter<CheatCompareDecreasedBy>(current, other, value, m_pCandidates, m_iSize);
+            break;
+    }
+
+    memcpy(m_pReference, current, m_iSize);
+
+    return m_iCandidateCount;
+}
+
+int CheatSearch::GetCandidateCount()
+{
+    return m_iCandidateCount;
+}
+
+void CheatSearch::GetCandidates(std::vector<int>& offsets)
+{
+    offsets.clear();
+
+    if (!IsActive())
+        return;
+
+    offsets.reserve(m_iCandidateCount);
+
+    for (int i = 0; i < m_iSize; i++)
+    {
+        if (m_pCandidates[i])
+            offsets.push_back(i);
+    }
+}
+
+int CheatSearch::GetSize()
+{
+    return m_iSize;
+}
+
+int CheatSearch::GetFrameCount()
+{
+    return m_iFrameCount;
+}
+
+u8 CheatSearch::GetValue(int offset)
+{
+    return GetSnapshot(0)[offset];
+}
+
+u8 CheatSearch::GetPrevious(int offset)
+{
+    return m_pReference[offset];
+}
+
+// CPU address where the byte is visible now, -1 if its RAM bank is not mapped.
+// With cartridge RAM disabled the same addresses read ROM, a code there
+// would patch the game instead of the value
+int CheatSearch::GetAddress(int offset)
+{
+    if (offset < GS_CHEAT_SEARCH_WORK_RAM)
+        return 0xC000 + offset;
+
+    offset -= GS_CHEAT_SEARCH_WORK_RAM;
+
+    MemoryRule* rule = m_pMemory->GetCurrentRule();
+
+    if (!IsValidPointer(rule) || !rule->IsRamEnabled())
+        return -1;
+
+    switch (m_pCartridge->GetType())
+    {
+        case Cartridge::CartridgeSegaMapper:
+            if ((offset >> 14) == rule->GetRamBank())
+                return 0x8000 + (offset & 0x3FFF);
+            return -1;
+        case Cartridge::CartridgeCodemastersMapper:
+            return 0xA000 + offset;
+        default:
+            return -1;
+    }
+}
+
+bool CheatSearch::GetCheatCode(int offset, u8 value, std::string& code)
+{
+    int address = GetAddress(offset);
+
+    if (address < 0)
+        return false;
+
+    char text[10];
+    snprintf(text, sizeof(text), "00%02X-%02X%02X", (address >> 8) & 0xFF, address & 0xFF, value);
+    code = text;
+
+    return true;
+}
+
+u8* CheatSearch::GetCartRAM(int& size)
+{
+    MemoryRule* rule = m_pMemory->GetCurrentRule();
+    u8* ram = NULL;
+    size = 0;
+
+    if (!IsValidPointer(rule))
+        return NULL;
+
+    switch (m_pCartridge->GetType())
+    {
+        case Cartridge::CartridgeSegaMapper:
+            size = static_cast<int>(rule->GetRamSize());
+            ram = rule->GetRamBanks();
+            break;
+        case Cartridge::CartridgeCodemastersMapper:
+            ram = rule->GetRamBanks();
+            size = IsValidPointer(ram) ? 0x2000 : 0;
+            break;
+        default:
+            break;
+    }
+
+    if (!IsValidPointer(ram))
+        size = 0;
+
+    return (size > 0) ? ram : NULL;
+}
+
+u8* CheatSearch::GetSnapshot(int age)
+{
+    int index = (m_iPosition - age + GS_CHEAT_SEARCH_FRAMES) % GS_CHEAT_SEARCH_FRAMES;
+    return m_pSnapshots + (index * m_iSize);
+}
@@ -0,0 +1,93 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef CHEATSEARCH_H
+#define	CHEATSEARCH_H
+
+#include <string>
+#include <vector>
+#include "definitions.h"
+
+#define GS_CHEAT_SEARCH_FRAMES 16
+#define GS_CHEAT_SEARCH_WORK_RAM 0x2000
+
+class Memory;
+class Cartridge;
+
+class CheatSearch
+{
+public:
+    enum Relation
+    {
+        RelationEqual,
+        RelationNotEqual,
+        RelationGreater,
+        RelationLess,
+        RelationIncreasedBy,
+        RelationDecreasedBy
+    };
+
+    enum Operand
+    {
+        OperandPrevious,
+        OperandFrames,
+        OperandValue
+    };
+
+public:
+    CheatSearch(Memory* pMemory, Cartridge* pCartridge);
+    ~CheatSearch();
+    void Start();
+    void Stop();
+    bool IsActive();
+    void Capture();
+    int Filter(Relation relation, Operand operand, u8 value, int frames = 0);
+    int GetCandidateCount();
+    void GetCandidates(std::vector<int>& offsets);
+    int GetSize();
+    int GetFrameCount();
+    u8 GetValue(int offset);
+    u8 GetPrevious(int offset);
+    int GetAddress(int offset);
+    bool GetCheatCode(int offset, u8 value, std::string& code);
+
+private:
+    u8* GetCartRAM(int& size);
+    u8* GetSnapshot(int age);
+
+private:
+    Memory* m_pMemory;
+    Cartridge* m_pCartridge;
+    u8* m_pSnapshots;
+    u8* m_pReference;
+    u8* m_pOperand;
+    u8* m_pCandidates;
+    int m_iSize;
+    int m_iCartRAMSize;
+    int m_iPosition;
+    int m_iFrameCount;
+    int m_iCandidateCount;
+};
+
+inline bool CheatSearch::IsActive()
+{
+    return IsValidPointer(m_pSnapshots);
+}
+
+#endif	/* CHEATSEARCH_H */
@@ -21,15 +21,14 @@
 #include "Memory.h"
 #include "Cartridge.h"
 
-CodemastersMemoryRule::CodemastersMemoryRule(Memory* pMemory, Cartridge* pCartridge) : MemoryRule(pMemory, pCartridge)
+CodemastersMemoryRule::CodemastersMemoryRule(Memory* pMemory, Cartridge* pCartridge, u8* pCartRAM) : MemoryRule(pMemory, pCartridge)
 {
-    m_pCartRAM = new u8[0x2000];
+    m_pCartRAM = pCartRAM;
     Reset();
 }
 
 CodemastersMemoryRule::~CodemastersMemoryRule()
 {
-    SafeDeleteArray(m_pCartRAM);
 }
 
 u8 CodemastersMemoryRule::PerformRead(u16 address)
@@ -96,7 +95,7 @@ void CodemastersMemoryRule::PerformWrite(u16 address, u8 value)
             {
                 if (!m_pCartridge->HasRAMWithoutBattery())
                 {
-                    Log("--> ** Attempting to write on ROM address $%X %X", address, value);
+                    Log_Debug("--> ** Attempting to write on ROM address $%X %X", address, value);
                 }
             }
         }
@@ -139,6 +138,11 @@ u8* CodemastersMemoryRule::GetRamBanks()
     return m_bRAMBankActive ? m_pCartRAM : NULL;
 }
 
+bool CodemastersMemoryRule::IsRamEnabled()
+{
+    return m_bRAMBankActive;
+}
+
 u8* CodemastersMemoryRule::GetPage(int index)
 {
     if ((index >= 0) && (index < 3))
@@ -179,3 +183,12 @@ void CodemastersMemoryRule::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (m_pCartRAM), 0x2000);
     stream.read(reinterpret_cast<char*> (&m_bRAMBankActive), sizeof(m_bRAMBankActive));
 }
+
+void CodemastersMemoryRule::CopyState(const MemoryRule* pSource)
+{
+    const CodemastersMemoryRule* source = static_cast<const CodemastersMemoryRule*>(pSource);
+
+    memcpy(m_iMapperSlot, source->m_iMapperSlot, sizeof(m_iMapperSlot));
+    memcpy(m_iMapperSlotAddress, source->m_iMapperSlotAddress, sizeof(m_iMapperSlotAddress));
+    m_bRAMBankActive = source->m_bRAMBankActive;
+}
@@ -25,16 +25,18 @@
 class CodemastersMemoryRule : public MemoryRule
 {
 public:
-    CodemastersMemoryRule(Memory* pMemory, Cartridge* pCartridge);
+    CodemastersMemoryRule(Memory* pMemory, Cartridge* pCartridge, u8* pCartRAM);
     virtual ~CodemastersMemoryRule();
     virtual u8 PerformRead(u16 address);
     virtual void PerformWrite(u16 address, u8 value);
     virtual void Reset();
     virtual u8* GetRamBanks();
+    virtual bool IsRamEnabled();
     virtual u8* GetPage(int index);
     virtual int GetBank(int index);
     virtual void SaveState(std::ostream& stream);
     virtual void LoadState(std::istream& stream);
+    virtual void CopyState(const MemoryRule* pSource);
 
 private:
     int m_iMapperSlot[3];
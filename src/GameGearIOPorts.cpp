@@ -68,7 +68,7 @@ u8 GameGearIOPorts::DoInput(u8 port)
     else if (port < 0x40)
     {
         // Reads return $FF (GG)
-        Log("--> ** Attempting to read from port $%X", port);
+        Log_Debug("--> ** Attempting to read from port $%X", port);
         return 0xFF;
     }
     else if ((port >= 0x40) && (port < 0x80))
@@ -108,7 +108,7 @@ u8 GameGearIOPorts::DoInput(u8 port)
             }
             default:
             {
-                Log("--> ** Attempting to read from port $%X", port);
+                Log_Debug("--> ** Attempting to read from port $%X", port);
                 return 0xFF;
             }
         }
@@ -131,7 +131,7 @@ void GameGearIOPorts::DoOutput(u8 port, u8 value)
         // Writes to odd addresses go to I/O control register.
         if ((port & 0x01) == 0x00)
         {
-            Log("--> ** Output to memory control port $%X: %X", port, value);
+            Log_Debug("--> ** Output to memory control port $%X: %X", port, value);
         }
         else
         {
@@ -164,15 +164,15 @@ void GameGearIOPorts::DoOutput(u8 port, u8 value)
         // Writes have no effect.
         if ((port == 0xDE) || (port == 0xDF))
         {
-            Log("--> ** Output to keyboard port $%X: %X", port, value);
+            Log_Debug("--> ** Output to keyboard port $%X: %X", port, value);
         }
         else if ((port == 0xF0) || (port == 0xF1) || (port == 0xF2))
         {
-            Log("--> ** Output to YM2413 port $%X: %X", port, value);
+            Log_Debug("--> ** Output to YM2413 port $%X: %X", port, value);
         }
         else
         {
-            Log("--> ** Output to port $%X: %X", port, value);
+            Log_Debug("--> ** Output to port $%X: %X", port, value);
         }
     }
 #endif
@@ -193,3 +193,11 @@ void GameGearIOPorts::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (&m_Port3F), sizeof(m_Port3F));
     stream.read(reinterpret_cast<char*> (&m_Port3F_HC), sizeof(m_Port3F_HC));
 }
+
+void GameGearIOPorts::CopyState(const IOPorts* pSource)
+{
+    const GameGearIOPorts* source = static_cast<const GameGearIOPorts*>(pSource);
+
+    m_Port3F = source->m_Port3F;
+    m_Port3F_HC = source->m_Port3F_HC;
+}
@@ -33,9 +33,26 @@
 #include "SG1000MemoryRule.h"
 #include "SmsIOPorts.h"
 #include "GameGearIOPorts.h"
+#include "StateArena.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "Watchpoints.h"
+#include "CheatSearch.h"
+
+template <typename T>
+static void DestroyInArena(T*& p)
+{
+    if (IsValidPointer(p))
+    {
+        p->~T();
+        InitPointer(p);
+    }
+}
 
 GearsystemCore::GearsystemCore()
 {
+    InitPointer(m_pArena);
+    InitPointer(m_pBuffers);
     InitPointer(m_pMemory);
     InitPointer(m_pProcessor);
     InitPointer(m_pAudio);
@@ -50,88 +67,170 @@ GearsystemCore::GearsystemCore()
     InitPointer(m_pMSXMemoryRule);
     InitPointer(m_pSmsIOPorts);
     InitPointer(m_pGameGearIOPorts);
+    InitPointer(m_pProfiler);
+    InitPointer(m_pTracer);
+    InitPointer(m_pWatchpoints);
+    InitPointer(m_pCheatSearch);
+    InitPointer(m_pFrameStats);
+    m_iFrameStatsPos = 0;
+    m_iFrameStatsCount = 0;
     m_bPaused = true;
 }
 
 GearsystemCore::~GearsystemCore()
 {
-    SafeDelete(m_pGameGearIOPorts);
-    SafeDelete(m_pSmsIOPorts);
-    SafeDelete(m_pRomOnlyMemoryRule);
-    SafeDelete(m_pCodemastersMemoryRule);
-    SafeDelete(m_pSG1000MemoryRule);
-    SafeDelete(m_pSegaMemoryRule);
-    SafeDelete(m_pKoreanMemoryRule);
-    SafeDelete(m_pMSXMemoryRule);
-    SafeDelete(m_pCartridge);
-    SafeDelete(m_pInput);
-    SafeDelete(m_pVideo);
-    SafeDelete(m_pAudio);
-    SafeDelete(m_pProcessor);
-    SafeDelete(m_pMemory);
+    SafeDelete(m_pProfiler);
+    SafeDelete(m_pTracer);
+    SafeDelete(m_pWatchpoints);
+    SafeDelete(m_pCheatSearch);
+    SafeDeleteArray(m_pFrameStats);
+    DestroyInArena(m_pGameGearIOPorts);
+    DestroyInArena(m_pSmsIOPorts);
+    DestroyInArena(m_pRomOnlyMemoryRule);
+    DestroyInArena(m_pCodemastersMemoryRule);
+    DestroyInArena(m_pSG1000MemoryRule);
+    DestroyInArena(m_pSegaMemoryRule);
+    DestroyInArena(m_pKoreanMemoryRule);
+    DestroyInArena(m_pMSXMemoryRule);
+    DestroyInArena(m_pCartridge);
+    DestroyInArena(m_pInput);
+    DestroyInArena(m_pVideo);
+    DestroyInArena(m_pAudio);
+    DestroyInArena(m_pProcessor);
+    DestroyInArena(m_pMemory);
+    SafeDelete(m_pArena);
 }
 
 void GearsystemCore::Init()
 {
     Log("--== %s %s by Ignacio Sanchez ==--", GEARSYSTEM_TITLE, GEARSYSTEM_VERSION);
 
-    m_pMemory = new Memory();
-    m_pProcessor = new Processor(m_pMemory);
-    m_pAudio = new Audio();
-    m_pVideo = new Video(m_pMemory, m_pProcessor);
-    m_pInput = new Input(m_pProcessor);
-    m_pCartridge = new Cartridge();
-    m_pSmsIOPorts = new SmsIOPorts(m_pAudio, m_pVideo, m_pInput, m_pCartridge);
-    m_pGameGearIOPorts = new GameGearIOPorts(m_pAudio, m_pVideo, m_pInput, m_pCartridge);
-
-    m_pMemory->Init();
+    // All components and their state buffers live in one aligned block
+    size_t arena_size = StateArena::Align(sizeof(Memory)) +
+            StateArena::Align(sizeof(Processor)) +
+            StateArena::Align(sizeof(Video)) +
+            StateArena::Align(sizeof(Input)) +
+            StateArena::Align(sizeof(Audio)) +
+            StateArena::Align(sizeof(Cartridge)) +
+            StateArena::Align(sizeof(SmsIOPorts)) +
+            StateArena::Align(sizeof(GameGearIOPorts)) +
+            StateArena::Align(sizeof(GS_StateBuffers)) +
+            StateArena::Align(sizeof(SG1000MemoryRule)) +
+            StateArena::Align(sizeof(CodemastersMemoryRule)) +
+            StateArena::Align(sizeof(SegaMemoryRule)) +
+            StateArena::Align(sizeof(RomOnlyMemoryRule)) +
+            StateArena::Align(sizeof(KoreanMemoryRule)) +
+            StateArena::Align(sizeof(MSXMemoryRule));
+
+    m_pArena = new StateArena();
+    m_pArena->Init(arena_size);
+
+    m_pMemory = new (m_pArena->Allocate(sizeof(Memory))) Memory();
+    m_pProcessor = new (m_pArena->Allocate(sizeof(Processor))) Processor(m_pMemory);
+    m_pVideo = new (m_pArena->Allocate(sizeof(Video))) Video(m_pMemory, m_pProcessor);
+    m_pInput = new (m_pArena->Allocate(sizeof(Input))) Input(m_pProcessor);
+    m_pAudio = new (m_pArena->Allocate(sizeof(Audio))) Audio();
+    m_pCartridge = new (m_pArena->Allocate(sizeof(Cartridge))) Cartridge();
+    m_pSmsIOPorts = new (m_pArena->Allocate(sizeof(SmsIOPorts))) SmsIOPorts(m_pAudio, m_pVideo, m_pInput, m_pCartridge);
+    m_pGameGearIOPorts = new (m_pArena->Allocate(sizeof(GameGearIOPorts))) GameGearIOPorts(m_pAudio, m_pVideo, m_pInput, m_pCartridge);
+
+    m_pBuffers = new (m_pArena->Allocate(sizeof(GS_StateBuffers))) GS_StateBuffers;
+
+    m_pMemory->Init(m_pBuffers->memory_map);
     m_pProcessor->Init();
     m_pAudio->Init();
-    m_pVideo->Init();
+    m_pVideo->Init(m_pBuffers->vdp_vram, m_pBuffers->vdp_cram, m_pBuffers->vdp_info_buffer);
     m_pInput->Init();
     m_pCartridge->Init();
 
+    m_pProfiler = new Profiler(m_pMemory, m_pCartridge);
+    m_pTracer = new Tracer();
+    m_pProcessor->SetTracer(m_pTracer);
+    m_pWatchpoints = new Watchpoints(m_pMemory, m_pProcessor);
+    m_pMemory->SetWatchpoints(m_pWatchpoints);
+    m_pProcessor->SetWatchpoints(m_pWatchpoints);
+    m_pVideo->SetWatchpoints(m_pWatchpoints);
+    m_pFrameStats = new Processor::FrameStats[GS_FRAME_STATS_HISTORY];
+    m_pCheatSearch = new CheatSearch(m_pMemory, m_pCartridge);
+
     InitMemoryRules();
 }
 
-bool GearsystemCore::RunToVBlank(GS_Color* pFrameBuffer, s16* pSampleBuffer, int* pSampleCount, bool step, bool stopOnBreakpoints)
+// Instantiated with and without the profiler so the loop does not test it
+template <bool profile>
+bool GearsystemCore::RunInstructions(void* pFrameBuffer, bool step, bool stopOnBreakpoints, bool& breakpoint)
+{
+    bool vblank = false;
+    bool frame = false;
+    int totalClocks = 0;
+
+    while (!vblank)
+    {
+        u16 pc = profile ? m_pProcessor->GetState()->PC->GetValue() : 0;
+        unsigned int clockCycles = m_pProcessor->Tick();
+
+        if (profile)
+            m_pProfiler->AddCycles(pc, clockCycles);
+
+        vblank = m_pVideo->Tick(clockCycles, pFrameBuffer);
+        frame = vblank;
+        m_pAudio->Tick(clockCycles);
+        m_pInput->Tick(clockCycles);
+
+        if ((step || (stopOnBreakpoints && m_pProcessor->BreakpointHit())))
+        {
+            vblank = true;
+            if (m_pProcessor->BreakpointHit())
+                breakpoint = true;
+        }
+
+        totalClocks += clockCycles;
+
+        if (totalClocks > 702240)
+        {
+            vblank = true;
+            frame = true;
+        }
+    }
+
+    return frame;
+}
+
+bool GearsystemCore::RunToVBlank(void* pFrameBuffer, s16* pSampleBuffer, int* pSampleCount, bool step, bool stopOnBreakpoints)
 {
     bool breakpoint = false;
 
     if (!m_bPaused && m_pCartridge->IsReady())
     {
-        bool vblank = false;
-        int totalClocks = 0;
-        while (!vblank)
-        {
-            unsigned int clockCycles = m_pProcessor->Tick();
-            vblank = m_pVideo->Tick(clockCycles, pFrameBuffer);
-            m_pAudio->Tick(clockCycles);
-            m_pInput->Tick(clockCycles);
-            
+        m_pMemory->ApplyProActionReplayCodes();
 
-            if ((step || (stopOnBreakpoints && m_pProcessor->BreakpointHit())))
-            {
-                vblank = true;
-                if (m_pProcessor->BreakpointHit())
-                    breakpoint = true;
-            }
+        bool frame;
 
-            totalClocks += clockCycles;
+        if (m_pProfiler->IsEnabled())
+            frame = RunInstructions<true>(pFrameBuffer, step, stopOnBreakpoints, breakpoint);
+        else
+            frame = RunInstructions<false>(pFrameBuffer, step, stopOnBreakpoints, breakpoint);
 
-            if (totalClocks > 702240)
-                vblank = true;
+        // Frames cut by a step or a breakpoint keep accumulating
+        if (frame && m_pProcessor->IsFrameStatsEnabled())
+        {
+            m_pProcessor->EndFrameStats(m_pFrameStats[m_iFrameStatsPos]);
+            m_iFrameStatsPos = (m_iFrameStatsPos + 1) % GS_FRAME_STATS_HISTORY;
+            m_iFrameStatsCount = std::min(m_iFrameStatsCount + 1, GS_FRAME_STATS_HISTORY);
         }
 
+        if (frame && m_pCheatSearch->IsActive())
+            m_pCheatSearch->Capture();
+
         m_pAudio->EndFrame(pSampleBuffer, pSampleCount);
     }
 
     return breakpoint;
 }
 
-bool GearsystemCore::LoadROM(const char* szFilePath, Cartridge::ForceConfiguration* config)
+bool GearsystemCore::LoadROM(const char* szFilePath, Cartridge::ForceConfiguration* config, int zipEntry)
 {
-    if (m_pCartridge->LoadFromFile(szFilePath))
+    if (m_pCartridge->LoadFromFile(szFilePath, zipEntry))
     {
         if (IsValidPointer(config))
             m_pCartridge->ForceConfig(*config);
@@ -142,7 +241,7 @@ bool GearsystemCore::LoadROM(const char* szFilePath, Cartridge::ForceConfigurati
 
         if (!romTypeOK)
         {
-            Log("There was a problem with the cartridge header. File: %s...", szFilePath);
+            Log_Warning("There was a problem with the cartridge header. File: %s...", szFilePath);
         }
 
         return romTypeOK;
@@ -163,7 +262,7 @@ bool GearsystemCore::LoadROMFromBuffer(const u8* buffer, int size, Cartridge::Fo
 
         if (!romTypeOK)
         {
-            Log("There was a problem with the cartridge header.");
+            Log_Warning("There was a problem with the cartridge header.");
         }
 
         return romTypeOK;
@@ -263,6 +362,57 @@ Audio* GearsystemCore::GetAudio()
     return m_pAudio;
 }
 
+Profiler* GearsystemCore::GetProfiler()
+{
+    return m_pProfiler;
+}
+
+Tracer* GearsystemCore::GetTracer()
+{
+    return m_pTracer;
+}
+
+Watchpoints* GearsystemCore::GetWatchpoints()
+{
+    return m_pWatchpoints;
+}
+
+CheatSearch* GearsystemCore::GetCheatSearch()
+{
+    return m_pCheatSearch;
+}
+
+void GearsystemCore::EnableFrameStats(bool enable)
+{
+    if (enable && !m_pProcessor->IsFrameStatsEnabled())
+    {
+        m_iFrameStatsPos = 0;
+        m_iFrameStatsCount = 0;
+    }
+
+    m_pProcessor->EnableFrameStats(enable);
+}
+
+bool GearsystemCore::IsFrameStatsEnabled()
+{
+    return m_pProcessor->IsFrameStatsEnabled();
+}
+
+int GearsystemCore::GetFrameStatsCount()
+{
+    return m_iFrameStatsCount;
+}
+
+// Age 0 is the last complete frame
+const Processor::FrameStats* GearsystemCore::GetFrameStats(int age)
+{
+    if ((age < 0) || (age >= m_iFrameStatsCount))
+        return NULL;
+
+    int index = (m_iFrameStatsPos - 1 - age + GS_FRAME_STATS_HISTORY) % GS_FRAME_STATS_HISTORY;
+    return &m_pFrameStats[index];
+}
+
 Video* GearsystemCore::GetVideo()
 {
     return m_pVideo;
@@ -472,7 +622,7 @@ void GearsystemCore::LoadRam(const char* szPath, bool fullPath)
             }
             else
             {
-                Log("Save file size incorrect: %d", fileSize);
+                Log_Warning("Save file size incorrect: %d", fileSize);
             }
         }
         else
@@ -562,7 +712,7 @@ bool GearsystemCore::SaveState(u8* buffer, size_t& size)
     }
     else
     {
-        Log("Invalid rom or memory rule.");
+        Log_Error("Invalid rom or memory rule.");
     }
 
     return ret;
@@ -598,7 +748,7 @@ bool GearsystemCore::SaveState(std::ostream& stream, size_t& size)
         return true;
     }
 
-    Log("Invalid rom or memory rule.");
+    Log_Error("Invalid rom or memory rule.");
 
     return false;
 }
@@ -682,7 +832,7 @@ bool GearsystemCore::LoadState(const u8* buffer, size_t size)
         return LoadState(stream);
     }
 
-    Log("Invalid rom or memory rule.");
+    Log_Error("Invalid rom or memory rule.");
 
     return false;
 }
@@ -726,17 +876,197 @@ bool GearsystemCore::LoadState(std::istream& stream)
         }
         else
         {
-            Log("Invalid save state size or header");
+            Log_Error("Invalid save state size or header");
         }
     }
     else
     {
-        Log("Invalid rom or memory rule");
+        Log_Error("Invalid rom or memory rule");
     }
 
     return false;
 }
 
+static std::string GetBootSnapshotTag(int frames)
+{
+    char tag[16];
+    snprintf(tag, sizeof(tag), "f%d", frames);
+    return tag;
+}
+
+// The tag names the point the snapshot was taken at, like the number of
+// frames run after power on
+std::string GearsystemCore::GetBootSnapshotPath(const char* szDirectory, const char* szTag)
+{
+    // Snapshots are only valid for the same ROM, core version and config.
+    // The resolved system, region, mapper and zone cover any forced value
+    char file_name[64];
+    char system = m_pCartridge->IsGameGear() ? 'g' : (m_pCartridge->IsSG1000() ? 's' : 'm');
+    char region = m_pCartridge->IsPAL() ? 'p' : 'n';
+    int mapper = static_cast<int>(m_pCartridge->GetType());
+    int zone = static_cast<int>(m_pCartridge->GetZone());
+
+    snprintf(file_name, sizeof(file_name), "%08X_%s_%c%c%d%d_", m_pCartridge->GetCRC(), GEARSYSTEM_VERSION, system, region, mapper, zone);
+
+    // Tags become part of the file name, anything but letters, digits, - and _ is replaced
+    std::string tag = IsValidPointer(szTag) ? szTag : "";
+
+    for (size_t i = 0; i < tag.length(); i++)
+    {
+        if (!isalnum(static_cast<unsigned char>(tag[i])) && (tag[i] != '-') && (tag[i] != '_'))
+            tag[i] = '_';
+    }
+
+    std::string path = IsValidPointer(szDirectory) ? szDirectory : "";
+
+    if ((path.length() > 0) && (path[path.length() - 1] != '/') && (path[path.length() - 1] != '\\'))
+        path += "/";
+
+    return path + file_name + tag + ".boot";
+}
+
+bool GearsystemCore::CreateBootSnapshot(const char* szDirectory, int frames)
+{
+    if (!m_pCartridge->IsReady())
+        return false;
+
+    Log("Running %d frames before creating boot snapshot...", frames);
+
+    bool paused = m_bPaused;
+
+    m_bPaused = false;
+
+    for (int i = 0; i < frames; i++)
+        RunToVBlank(NULL, NULL, NULL);
+
+    m_bPaused = paused;
+
+    return SaveBootSnapshot(szDirectory, GetBootSnapshotTag(frames).c_str());
+}
+
+bool GearsystemCore::SaveBootSnapshot(const char* szDirectory, const char* szTag)
+{
+    using namespace std;
+
+    stringstream stream;
+    size_t size;
+
+    if (!SaveState(stream, size))
+        return false;
+
+    string path = GetBootSnapshotPath(szDirectory, szTag);
+    string temp_path = path + ".tmp";
+
+    Log("Saving boot snapshot: %s", path.c_str());
+
+    // Write aside and rename so concurrent readers never see a partial file
+    ofstream file(temp_path.c_str(), ios::out | ios::binary);
+
+    if (!file.is_open())
+    {
+        Log_Error("Unable to create boot snapshot %s", temp_path.c_str());
+        return false;
+    }
+
+    file << stream.rdbuf();
+    file.close();
+
+    if (file.fail())
+    {
+        remove(temp_path.c_str());
+        return false;
+    }
+
+#if defined(_WIN32)
+    remove(path.c_str());
+#endif
+
+    if (rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        remove(temp_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool GearsystemCore::LoadBootSnapshot(const char* szDirectory, int frames)
+{
+    return LoadBootSnapshot(szDirectory, GetBootSnapshotTag(frames).c_str());
+}
+
+bool GearsystemCore::LoadBootSnapshot(const char* szDirectory, const char* szTag)
+{
+    using namespace std;
+
+    if (!m_pCartridge->IsReady())
+        return false;
+
+    string path = GetBootSnapshotPath(szDirectory, szTag);
+
+    ifstream file(path.c_str(), ios::in | ios::binary);
+
+    if (!file.is_open())
+    {
+        Log("Boot snapshot not found: %s", path.c_str());
+        return false;
+    }
+
+    // Read it whole, LoadState seeks around the stream
+    stringstream stream;
+    stream << file.rdbuf();
+
+    if (!LoadState(stream))
+        return false;
+
+    Log("Boot snapshot loaded: %s", path.c_str());
+
+    return true;
+}
+
+bool GearsystemCore::Clone(GearsystemCore* pTarget)
+{
+    if ((pTarget == this) || !m_pCartridge->IsReady() || !IsValidPointer(m_pMemory->GetCurrentRule()))
+        return false;
+
+    Cartridge* target_cartridge = pTarget->m_pCartridge;
+
+    bool same_rom = target_cartridge->IsReady() &&
+            (target_cartridge->GetCRC() == m_pCartridge->GetCRC()) &&
+            (target_cartridge->GetROMSize() == m_pCartridge->GetROMSize()) &&
+            (target_cartridge->GetType() == m_pCartridge->GetType()) &&
+            (target_cartridge->GetZone() == m_pCartridge->GetZone()) &&
+            (target_cartridge->IsGameGear() == m_pCartridge->IsGameGear()) &&
+            (target_cartridge->IsSG1000() == m_pCartridge->IsSG1000()) &&
+            (target_cartridge->IsPAL() == m_pCartridge->IsPAL());
+
+    if (!same_rom)
+    {
+        // Only the first clone into a target pays for the ROM and the setup
+        Log("Loading ROM into clone target...");
+
+        Cartridge::ForceConfiguration config;
+        config.type = m_pCartridge->GetType();
+        config.zone = m_pCartridge->GetZone();
+        config.region = m_pCartridge->IsPAL() ? Cartridge::CartridgePAL : Cartridge::CartridgeNTSC;
+        config.system = m_pCartridge->IsGameGear() ? Cartridge::CartridgeGG : (m_pCartridge->IsSG1000() ? Cartridge::CartridgeSG1000 : Cartridge::CartridgeSMS);
+
+        if (!pTarget->LoadROMFromBuffer(m_pCartridge->GetROM(), m_pCartridge->GetROMSize(), &config))
+            return false;
+    }
+
+    memcpy(pTarget->m_pBuffers, m_pBuffers, sizeof(GS_StateBuffers));
+    pTarget->m_pProcessor->CopyState(m_pProcessor);
+    pTarget->m_pAudio->CopyState(m_pAudio);
+    pTarget->m_pVideo->CopyState(m_pVideo);
+    pTarget->m_pInput->CopyState(m_pInput);
+    pTarget->m_pMemory->GetCurrentRule()->CopyState(m_pMemory->GetCurrentRule());
+    pTarget->m_pProcessor->GetIOPOrts()->CopyState(m_pProcessor->GetIOPOrts());
+    pTarget->m_bPaused = m_bPaused;
+
+    return true;
+}
+
 void GearsystemCore::SetCheat(const char* szCheat)
 {
     std::string s = szCheat;
@@ -766,12 +1096,12 @@ void GearsystemCore::SetRamModificationCallback(RamChangedCallback callback)
 
 void GearsystemCore::InitMemoryRules()
 {
-    m_pSG1000MemoryRule = new SG1000MemoryRule(m_pMemory, m_pCartridge);
-    m_pCodemastersMemoryRule = new CodemastersMemoryRule(m_pMemory, m_pCartridge);
-    m_pSegaMemoryRule = new SegaMemoryRule(m_pMemory, m_pCartridge);
-    m_pRomOnlyMemoryRule = new RomOnlyMemoryRule(m_pMemory, m_pCartridge);
-    m_pKoreanMemoryRule = new KoreanMemoryRule(m_pMemory, m_pCartridge);
-    m_pMSXMemoryRule = new MSXMemoryRule(m_pMemory, m_pCartridge);
+    m_pSG1000MemoryRule = new (m_pArena->Allocate(sizeof(SG1000MemoryRule))) SG1000MemoryRule(m_pMemory, m_pCartridge);
+    m_pCodemastersMemoryRule = new (m_pArena->Allocate(sizeof(CodemastersMemoryRule))) CodemastersMemoryRule(m_pMemory, m_pCartridge, m_pBuffers->codemasters_cart_ram);
+    m_pSegaMemoryRule = new (m_pArena->Allocate(sizeof(SegaMemoryRule))) SegaMemoryRule(m_pMemory, m_pCartridge, m_pBuffers->sega_ram_banks);
+    m_pRomOnlyMemoryRule = new (m_pArena->Allocate(sizeof(RomOnlyMemoryRule))) RomOnlyMemoryRule(m_pMemory, m_pCartridge);
+    m_pKoreanMemoryRule = new (m_pArena->Allocate(sizeof(KoreanMemoryRule))) KoreanMemoryRule(m_pMemory, m_pCartridge);
+    m_pMSXMemoryRule = new (m_pArena->Allocate(sizeof(MSXMemoryRule))) MSXMemoryRule(m_pMemory, m_pCartridge);
 
     m_pMemory->SetCurrentRule(m_pRomOnlyMemoryRule);
     m_pProcessor->SetIOPOrts(m_pSmsIOPorts);
@@ -837,6 +1167,10 @@ void GearsystemCore::Reset()
     m_pRomOnlyMemoryRule->Reset();
     m_pGameGearIOPorts->Reset();
     m_pSmsIOPorts->Reset();
+    m_pProfiler->Clear();
+    m_pCheatSearch->Stop();
+    m_iFrameStatsPos = 0;
+    m_iFrameStatsCount = 0;
     m_bPaused = false;
 }
 
@@ -856,3 +1190,13 @@ void GearsystemCore::Get16BitFrameBuffer(GS_Color* pFrameBuffer, u16* p16BitFram
         }
     }
 }
+
+void GearsystemCore::SetPixelFormat(GS_Pixel_Format format)
+{
+    m_pVideo->SetPixelFormat(format);
+}
+
+void GearsystemCore::SetFrameBufferLayout(int pitch, int height)
+{
+    m_pVideo->SetFrameBufferLayout(pitch, height);
+}
@@ -22,6 +22,9 @@
 
 #include "definitions.h"
 #include "Cartridge.h"
+#include "Processor.h"
+
+#define GS_FRAME_STATS_HISTORY 256
 
 class Memory;
 class Processor;
@@ -37,6 +40,12 @@ class MSXMemoryRule;
 class MemoryRule;
 class SmsIOPorts;
 class GameGearIOPorts;
+class StateArena;
+class Profiler;
+class Tracer;
+class Watchpoints;
+class CheatSearch;
+struct GS_StateBuffers;
 
 class GearsystemCore
 {
@@ -44,8 +53,8 @@ public:
     GearsystemCore();
     ~GearsystemCore();
     void Init();
-    bool RunToVBlank(GS_Color* pFrameBuffer, s16* pSampleBuffer, int* pSampleCount, bool step = false, bool stopOnBreakpoints = false);
-    bool LoadROM(const char* szFilePath, Cartridge::ForceConfiguration* config = NULL);
+    bool RunToVBlank(void* pFrameBuffer, s16* pSampleBuffer, int* pSampleCount, bool step = false, bool stopOnBreakpoints = false);
+    bool LoadROM(const char* szFilePath, Cartridge::ForceConfiguration* config = NULL, int zipEntry = -1);
     bool LoadROMFromBuffer(const u8* buffer, int size, Cartridge::ForceConfiguration* config = NULL);
     void SaveMemoryDump();
     void SaveDisassembledROM();
@@ -71,6 +80,12 @@ public:
     void LoadState(const char* szPath, int index);
     bool LoadState(const u8* buffer, size_t size);
     bool LoadState(std::istream& stream);
+    std::string GetBootSnapshotPath(const char* szDirectory, const char* szTag);
+    bool CreateBootSnapshot(const char* szDirectory, int frames);
+    bool SaveBootSnapshot(const char* szDirectory, const char* szTag);
+    bool LoadBootSnapshot(const char* szDirectory, const char* szTag);
+    bool LoadBootSnapshot(const char* szDirectory, int frames);
+    bool Clone(GearsystemCore* pTarget);
     void SetCheat(const char* szCheat);
     void ClearCheats();
     void SetRamModificationCallback(RamChangedCallback callback);
@@ -78,16 +93,30 @@ public:
     Cartridge* GetCartridge();
     void SetSG1000Palette(GS_Color* pSG1000Palette);
     void Get16BitFrameBuffer(GS_Color* pFrameBuffer, u16* p16BitFrameBuffer);
+    void SetPixelFormat(GS_Pixel_Format format);
+    void SetFrameBufferLayout(int pitch, int height);
     Processor* GetProcessor();
     Audio* GetAudio();
     Video* GetVideo();
+    Profiler* GetProfiler();
+    Tracer* GetTracer();
+    Watchpoints* GetWatchpoints();
+    CheatSearch* GetCheatSearch();
+    void EnableFrameStats(bool enable);
+    bool IsFrameStatsEnabled();
+    int GetFrameStatsCount();
+    const Processor::FrameStats* GetFrameStats(int age);
 
 private:
     void InitMemoryRules();
     bool AddMemoryRules();
     void Reset();
+    template <bool profile>
+    bool RunInstructions(void* pFrameBuffer, bool step, bool stopOnBreakpoints, bool& breakpoint);
 
 private:
+    StateArena* m_pArena;
+    GS_StateBuffers* m_pBuffers;
     Memory* m_pMemory;
     Processor* m_pProcessor;
     Audio* m_pAudio;
@@ -102,6 +131,13 @@ private:
     MSXMemoryRule* m_pMSXMemoryRule;
     SmsIOPorts* m_pSmsIOPorts;
     GameGearIOPorts* m_pGameGearIOPorts;
+    Profiler* m_pProfiler;
+    Tracer* m_pTracer;
+    Watchpoints* m_pWatchpoints;
+    CheatSearch* m_pCheatSearch;
+    Processor::FrameStats* m_pFrameStats;
+    int m_iFrameStatsPos;
+    int m_iFrameStatsCount;
     bool m_bPaused;
     RamChangedCallback m_pRamChangedCallback;
 };
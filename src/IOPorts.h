@@ -32,6 +32,7 @@ public:
     virtual void DoOutput(u8 port, u8 value) = 0;
     virtual void SaveState(std::ostream& stream) = 0;
     virtual void LoadState(std::istream& stream) = 0;
+    virtual void CopyState(const IOPorts* pSource) = 0;
 };
 
 #endif	/* IOPORTS_H */
@@ -126,3 +126,13 @@ void Input::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (&m_IOPort00), sizeof(m_IOPort00));
     stream.read(reinterpret_cast<char*> (&m_iInputCycles), sizeof(m_iInputCycles));
 }
+
+void Input::CopyState(const Input* pSource)
+{
+    m_Joypad1 = pSource->m_Joypad1;
+    m_Joypad2 = pSource->m_Joypad2;
+    m_IOPortDC = pSource->m_IOPortDC;
+    m_IOPortDD = pSource->m_IOPortDD;
+    m_IOPort00 = pSource->m_IOPort00;
+    m_iInputCycles = pSource->m_iInputCycles;
+}
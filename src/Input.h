@@ -39,6 +39,7 @@ public:
     u8 GetPort00();
     void SaveState(std::ostream& stream);
     void LoadState(std::istream& stream);
+    void CopyState(const Input* pSource);
 
 private:
     void Update();
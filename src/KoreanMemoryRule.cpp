@@ -53,7 +53,7 @@ void KoreanMemoryRule::PerformWrite(u16 address, u8 value)
     if (address < 0x8000)
     {
         // ROM page 0 and 1
-        Log("--> ** Attempting to write on ROM address $%X %X", address, value);
+        Log_Debug("--> ** Attempting to write on ROM address $%X %X", address, value);
     }
     else if (address < 0xC000)
     {
@@ -65,7 +65,7 @@ void KoreanMemoryRule::PerformWrite(u16 address, u8 value)
         else
         {
             // ROM page 2
-            Log("--> ** Attempting to write on ROM page 2 $%X %X", address, value);
+            Log_Debug("--> ** Attempting to write on ROM page 2 $%X %X", address, value);
         }
     }
     else if (address < 0xE000)
@@ -129,3 +129,11 @@ void KoreanMemoryRule::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (&m_iMapperSlot2), sizeof(m_iMapperSlot2));
     stream.read(reinterpret_cast<char*> (&m_iMapperSlot2Address), sizeof(m_iMapperSlot2Address));
 }
+
+void KoreanMemoryRule::CopyState(const MemoryRule* pSource)
+{
+    const KoreanMemoryRule* source = static_cast<const KoreanMemoryRule*>(pSource);
+
+    m_iMapperSlot2 = source->m_iMapperSlot2;
+    m_iMapperSlot2Address = source->m_iMapperSlot2Address;
+}
@@ -34,6 +34,7 @@ public:
     virtual int GetBank(int index);
     virtual void SaveState(std::ostream& stream);
     virtual void LoadState(std::istream& stream);
+    virtual void CopyState(const MemoryRule* pSource);
 
 private:
     int m_iMapperSlot2;
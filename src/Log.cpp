@@ -0,0 +1,225 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include "definitions.h"
+
+// GEARSYSTEM_LOG_LEVEL in the environment overrides the default from the
+// start, before any message is logged
+static int Log_initial_level()
+{
+    const char* env = getenv("GEARSYSTEM_LOG_LEVEL");
+
+    return IsValidPointer(env) ? atoi(env) : GEARSYSTEM_LOG_LEVEL;
+}
+
+std::atomic<int> gs_log_level(Log_initial_level());
+
+void Log_set_level(int level)
+{
+    gs_log_level.store(level, std::memory_order_relaxed);
+}
+
+#ifdef DEBUG_GEARSYSTEM
+
+#include <thread>
+#include <chrono>
+
+// Rate limit windows are whole seconds of the monotonic clock
+unsigned int Log_window()
+{
+    return static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#define GS_LOG_QUEUE_SIZE 1024
+#define GS_LOG_MESSAGE_SIZE 256
+
+// Bounded multi-producer queue, the emulation threads never block on it.
+// Each slot sequence tells whether it is free (== position) or written
+// (== position + 1) for the current lap of the ring.
+class Log_Sink
+{
+public:
+    Log_Sink()
+    {
+        for (unsigned int i = 0; i < GS_LOG_QUEUE_SIZE; i++)
+            m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+
+        m_iEnqueue.store(0, std::memory_order_relaxed);
+        m_iDequeue = 0;
+        m_iDropped.store(0, std::memory_order_relaxed);
+        m_iFlushRequest.store(0, std::memory_order_relaxed);
+        m_iFlushDone.store(0, std::memory_order_relaxed);
+        m_bQuit.store(false, std::memory_order_relaxed);
+
+        m_Thread = std::thread(&Log_Sink::Run, this);
+    }
+
+    ~Log_Sink()
+    {
+        m_bQuit.store(true, std::memory_order_release);
+        m_Thread.join();
+    }
+
+    void Push(int level, unsigned int suppressed, const char* msg, va_list args)
+    {
+        unsigned int pos = m_iEnqueue.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true)
+        {
+            slot = &m_Slots[pos & (GS_LOG_QUEUE_SIZE - 1)];
+            int diff = static_cast<int>(slot->sequence.load(std::memory_order_acquire) - pos);
+
+            if (diff == 0)
+            {
+                if (m_iEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                m_iDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+                pos = m_iEnqueue.load(std::memory_order_relaxed);
+        }
+
+        const char* prefix = (level == GS_LOG_ERROR) ? "ERROR: " : ((level == GS_LOG_WARNING) ? "WARNING: " : "");
+        int len = snprintf(slot->text, GS_LOG_MESSAGE_SIZE, "%u: %s", pos + 1, prefix);
+        len += vsnprintf(slot->text + len, GS_LOG_MESSAGE_SIZE - len, msg, args);
+
+        if ((suppressed > 0) && (len < GS_LOG_MESSAGE_SIZE))
+            snprintf(slot->text + len, GS_LOG_MESSAGE_SIZE - len, " (%u more suppressed)", suppressed);
+
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    void Flush()
+    {
+        unsigned int request = m_iFlushRequest.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+        while (static_cast<int>(m_iFlushDone.load(std::memory_order_acquire) - request) < 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<unsigned int> sequence;
+        char text[GS_LOG_MESSAGE_SIZE];
+    };
+
+    void Run()
+    {
+        while (true)
+        {
+            unsigned int request = m_iFlushRequest.load(std::memory_order_acquire);
+            bool quit = m_bQuit.load(std::memory_order_acquire);
+
+            Drain();
+
+            m_iFlushDone.store(request, std::memory_order_release);
+
+            if (quit)
+                return;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    void Drain()
+    {
+        bool written = false;
+
+        while (true)
+        {
+            Slot* slot = &m_Slots[m_iDequeue & (GS_LOG_QUEUE_SIZE - 1)];
+
+            if (slot->sequence.load(std::memory_order_acquire) != (m_iDequeue + 1))
+                break;
+
+            printf("%s\n", slot->text);
+            written = true;
+
+            slot->sequence.store(m_iDequeue + GS_LOG_QUEUE_SIZE, std::memory_order_release);
+            m_iDequeue++;
+        }
+
+        unsigned int dropped = m_iDropped.exchange(0, std::memory_order_relaxed);
+
+        if (dropped > 0)
+        {
+            printf("** %u log messages dropped\n", dropped);
+            written = true;
+        }
+
+        if (written)
+            fflush(stdout);
+    }
+
+private:
+    Slot m_Slots[GS_LOG_QUEUE_SIZE];
+    std::atomic<unsigned int> m_iEnqueue;
+    unsigned int m_iDequeue;
+    std::atomic<unsigned int> m_iDropped;
+    std::atomic<unsigned int> m_iFlushRequest;
+    std::atomic<unsigned int> m_iFlushDone;
+    std::atomic<bool> m_bQuit;
+    std::thread m_Thread;
+};
+
+static Log_Sink& Log_get_sink()
+{
+    static Log_Sink sink;
+    return sink;
+}
+
+void Log_func(int level, unsigned int suppressed, const char* const msg, ...)
+{
+    va_list args;
+    va_start(args, msg);
+    Log_get_sink().Push(level, suppressed, msg, args);
+    va_end(args);
+
+    // Errors often come right before a failure or an exit, print them now
+    if (level == GS_LOG_ERROR)
+        Log_get_sink().Flush();
+}
+
+void Log_flush()
+{
+    Log_get_sink().Flush();
+}
+
+#else
+
+unsigned int Log_window()
+{
+    return 0;
+}
+
+void Log_func(int, unsigned int, const char* const, ...)
+{
+}
+
+void Log_flush()
+{
+}
+
+#endif
@@ -81,7 +81,7 @@ void MSXMemoryRule::PerformWrite(u16 address, u8 value)
     }
     else if (address < 0xC000)
     {
-        Log("--> ** Attempting to write on ROM address $%X %X", address, value);
+        Log_Debug("--> ** Attempting to write on ROM address $%X %X", address, value);
     }
     else if (address < 0xE000)
     {
@@ -146,3 +146,11 @@ void MSXMemoryRule::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (m_iMapperSlot), sizeof(m_iMapperSlot));
     stream.read(reinterpret_cast<char*> (m_iMapperSlotAddress), sizeof(m_iMapperSlotAddress));
 }
+
+void MSXMemoryRule::CopyState(const MemoryRule* pSource)
+{
+    const MSXMemoryRule* source = static_cast<const MSXMemoryRule*>(pSource);
+
+    memcpy(m_iMapperSlot, source->m_iMapperSlot, sizeof(m_iMapperSlot));
+    memcpy(m_iMapperSlotAddress, source->m_iMapperSlotAddress, sizeof(m_iMapperSlotAddress));
+}
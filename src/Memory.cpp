@@ -20,6 +20,7 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <algorithm>
 #include "Memory.h"
 
 Memory::Memory()
@@ -29,11 +30,13 @@ Memory::Memory()
     InitPointer(m_pDisassembledMap);
     InitPointer(m_pDisassembledROMMap);
     InitPointer(m_pRunToBreakpoint);
+    InitPointer(m_pWatchpoints);
+    m_iDisassemblyRevision = 0;
+    ClearProActionReplayCodes();
 }
 
 Memory::~Memory()
 {
-    SafeDeleteArray(m_pMap);
     InitPointer(m_pCurrentMemoryRule);
 
     if (IsValidPointer(m_pDisassembledROMMap))
@@ -55,9 +58,9 @@ Memory::~Memory()
     }
 }
 
-void Memory::Init()
+void Memory::Init(u8* pMap)
 {
-    m_pMap = new u8[0x10000];
+    m_pMap = pMap;
 #ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
     m_pDisassembledMap = new stDisassembleRecord*[0x10000];
     for (int i = 0; i < 0x10000; i++)
@@ -70,6 +73,8 @@ void Memory::Init()
     {
         InitPointer(m_pDisassembledROMMap[i]);
     }
+
+    m_BreakpointBits.assign(MAX_ROM_SIZE + 0x4000, false);
 #endif
     m_Breakpoints.clear();
     InitPointer(m_pRunToBreakpoint);
@@ -94,6 +99,12 @@ void Memory::Reset()
             SafeDelete(m_pDisassembledROMMap[i]);
         }
     }
+
+    // Breakpoints point to the records deleted above
+    ResetBreakpoints();
+    InitPointer(m_pRunToBreakpoint);
+    m_iDisassemblyRevision++;
+    ClearProActionReplayCodes();
 }
 
 void Memory::SetCurrentRule(MemoryRule* pRule)
@@ -101,6 +112,11 @@ void Memory::SetCurrentRule(MemoryRule* pRule)
     m_pCurrentMemoryRule = pRule;
 }
 
+void Memory::SetWatchpoints(Watchpoints* pWatchpoints)
+{
+    m_pWatchpoints = pWatchpoints;
+}
+
 MemoryRule* Memory::GetCurrentRule()
 {
     return m_pCurrentMemoryRule;
@@ -111,6 +127,85 @@ u8* Memory::GetMemoryMap()
     return m_pMap;
 }
 
+static bool CompareProActionReplayCodes(const Memory::ProActionReplayCode& a, const Memory::ProActionReplayCode& b)
+{
+    return a.address < b.address;
+}
+
+// Codes are kept sorted by address, a new code for an address replaces the old one
+void Memory::AddProActionReplayCode(u16 address, u8 value)
+{
+    ProActionReplayCode code;
+    code.address = address;
+    code.value = value;
+
+    std::vector<ProActionReplayCode>::iterator it = std::lower_bound(m_ProActionReplayCodes.begin(), m_ProActionReplayCodes.end(), code, CompareProActionReplayCodes);
+
+    if ((it != m_ProActionReplayCodes.end()) && (it->address == address))
+        it->value = value;
+    else
+        m_ProActionReplayCodes.insert(it, code);
+
+    UpdateProActionReplayPages();
+
+    if (IsValidPointer(m_pCurrentMemoryRule))
+        m_pCurrentMemoryRule->PerformWrite(address, value);
+}
+
+void Memory::ClearProActionReplayCodes()
+{
+    m_ProActionReplayCodes.clear();
+    UpdateProActionReplayPages();
+}
+
+void Memory::ApplyProActionReplayCodes()
+{
+    if (!IsValidPointer(m_pCurrentMemoryRule))
+        return;
+
+    for (size_t i = 0; i < m_ProActionReplayCodes.size(); i++)
+        m_pCurrentMemoryRule->PerformWrite(m_ProActionReplayCodes[i].address, m_ProActionReplayCodes[i].value);
+}
+
+void Memory::UpdateProActionReplayPages()
+{
+    memset(m_ProActionReplayPages, 0, sizeof(m_ProActionReplayPages));
+
+    for (size_t i = 0; i < m_ProActionReplayCodes.size(); i++)
+    {
+        u16 address = m_ProActionReplayCodes[i].address;
+        m_ProActionReplayPages[address >> 8] = 1;
+
+        // Work RAM is also written through its mirror
+        if (address >= 0xC000)
+            m_ProActionReplayPages[(address ^ 0x2000) >> 8] = 1;
+    }
+}
+
+// Called after a write to a page with codes, the game value is overridden
+// right away instead of waiting for the next frame
+void Memory::ProActionReplayTrap(u16 address)
+{
+    ProActionReplayCode code;
+    code.address = address;
+
+    for (int i = 0; i < 2; i++)
+    {
+        std::vector<ProActionReplayCode>::iterator it = std::lower_bound(m_ProActionReplayCodes.begin(), m_ProActionReplayCodes.end(), code, CompareProActionReplayCodes);
+
+        if ((it != m_ProActionReplayCodes.end()) && (it->address == code.address))
+        {
+            m_pCurrentMemoryRule->PerformWrite(it->address, it->value);
+            return;
+        }
+
+        if (address < 0xC000)
+            return;
+
+        code.address = address ^ 0x2000;
+    }
+}
+
 void Memory::LoadSlotsFromROM(u8* pTheROM, int size)
 {
     // loads the first 48KB only (bank 0, 1 and 2)
@@ -169,6 +264,41 @@ std::vector<Memory::stDisassembleRecord*>* Memory::GetBreakpoints()
     return &m_Breakpoints;
 }
 
+void Memory::AddBreakpoint(stDisassembleRecord* pRecord)
+{
+    if (!IsValidPointer(pRecord) || m_BreakpointBits.empty() || IsBreakpoint(pRecord))
+        return;
+
+    m_Breakpoints.push_back(pRecord);
+    m_BreakpointBits[GetBreakpointIndex(pRecord)] = true;
+}
+
+void Memory::RemoveBreakpoint(stDisassembleRecord* pRecord)
+{
+    if (!IsValidPointer(pRecord) || !IsBreakpoint(pRecord))
+        return;
+
+    int index = GetBreakpointIndex(pRecord);
+    m_BreakpointBits[index] = false;
+
+    for (long unsigned int b = 0; b < m_Breakpoints.size(); b++)
+    {
+        if (GetBreakpointIndex(m_Breakpoints[b]) == index)
+        {
+            m_Breakpoints.erase(m_Breakpoints.begin() + b);
+            break;
+        }
+    }
+}
+
+void Memory::ResetBreakpoints()
+{
+    if (!m_Breakpoints.empty())
+        std::fill(m_BreakpointBits.begin(), m_BreakpointBits.end(), false);
+
+    m_Breakpoints.clear();
+}
+
 Memory::stDisassembleRecord* Memory::GetRunToBreakpoint()
 {
     return m_pRunToBreakpoint;
@@ -22,6 +22,7 @@
 
 #include "definitions.h"
 #include "MemoryRule.h"
+#include "Watchpoints.h"
 #include <vector>
 
 class Memory
@@ -36,15 +37,24 @@ public:
         int bank;
     };
 
+    struct ProActionReplayCode
+    {
+        u16 address;
+        u8 value;
+    };
+
 public:
     Memory();
     ~Memory();
-    void Init();
+    void Init(u8* pMap);
     void Reset();
     void SetCurrentRule(MemoryRule* pRule);
+    void SetWatchpoints(Watchpoints* pWatchpoints);
     MemoryRule* GetCurrentRule();
     u8* GetMemoryMap();
     u8 Read(u16 address);
+    u8 Peek(u16 address);
+    u8 FetchRead(u16 address);
     void Write(u16 address, u8 value);
     u8 Retrieve(u16 address);
     void Load(u16 address, u8 value);
@@ -55,8 +65,22 @@ public:
     void SaveState(std::ostream& stream);
     void LoadState(std::istream& stream);
     std::vector<stDisassembleRecord*>* GetBreakpoints();
+    bool IsBreakpoint(stDisassembleRecord* pRecord);
+    void AddBreakpoint(stDisassembleRecord* pRecord);
+    void RemoveBreakpoint(stDisassembleRecord* pRecord);
+    void ResetBreakpoints();
     stDisassembleRecord* GetRunToBreakpoint();
     void SetRunToBreakpoint(stDisassembleRecord* pBreakpoint);
+    u32 GetDisassemblyRevision();
+    void UpdateDisassemblyRevision();
+    void AddProActionReplayCode(u16 address, u8 value);
+    void ClearProActionReplayCodes();
+    void ApplyProActionReplayCodes();
+
+private:
+    int GetBreakpointIndex(stDisassembleRecord* pRecord);
+    void ProActionReplayTrap(u16 address);
+    void UpdateProActionReplayPages();
 
 private:
     MemoryRule* m_pCurrentMemoryRule;
@@ -64,7 +88,12 @@ private:
     stDisassembleRecord** m_pDisassembledMap;
     stDisassembleRecord** m_pDisassembledROMMap;
     std::vector<stDisassembleRecord*> m_Breakpoints;
+    std::vector<bool> m_BreakpointBits;
     stDisassembleRecord* m_pRunToBreakpoint;
+    u32 m_iDisassemblyRevision;
+    Watchpoints* m_pWatchpoints;
+    std::vector<ProActionReplayCode> m_ProActionReplayCodes;
+    u8 m_ProActionReplayPages[256];
 };
 
 #include "Memory_inline.h"
@@ -63,6 +63,11 @@ int MemoryRule::GetRamBank()
     return 0;
 }
 
+bool MemoryRule::IsRamEnabled()
+{
+    return false;
+}
+
 u8* MemoryRule::GetPage(int)
 {
     return NULL;
@@ -80,3 +85,7 @@ void MemoryRule::SaveState(std::ostream&)
 void MemoryRule::LoadState(std::istream&)
 {
 }
+
+void MemoryRule::CopyState(const MemoryRule*)
+{
+}
@@ -40,10 +40,12 @@ public:
     virtual size_t GetRamSize();
     virtual u8* GetRamBanks();
     virtual int GetRamBank();
+    virtual bool IsRamEnabled();
     virtual u8* GetPage(int index);
     virtual int GetBank(int index);
     virtual void SaveState(std::ostream& stream);
     virtual void LoadState(std::istream& stream);
+    virtual void CopyState(const MemoryRule* pSource);
 
 protected:
     Memory* m_pMemory;
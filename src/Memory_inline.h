@@ -21,13 +21,40 @@
 #define	MEMORY_INLINE_H
 
 inline u8 Memory::Read(u16 address)
+{
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+    if (IsValidPointer(m_pWatchpoints) && m_pWatchpoints->IsWatched(Watchpoints::SpaceCPU, address, Watchpoints::AccessRead))
+    {
+        u8 value = m_pCurrentMemoryRule->PerformRead(address);
+        m_pWatchpoints->Check(Watchpoints::SpaceCPU, address, value, Watchpoints::AccessRead);
+        return value;
+    }
+#endif
+    return m_pCurrentMemoryRule->PerformRead(address);
+}
+
+// Reads for the debugger and the tracer, they must not trigger watchpoints
+inline u8 Memory::Peek(u16 address)
+{
+    return m_pCurrentMemoryRule->PerformRead(address);
+}
+
+// Opcode and operand fetches, read watchpoints only cover data accesses
+inline u8 Memory::FetchRead(u16 address)
 {
     return m_pCurrentMemoryRule->PerformRead(address);
 }
 
 inline void Memory::Write(u16 address, u8 value)
 {
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+    if (IsValidPointer(m_pWatchpoints) && m_pWatchpoints->IsWatched(Watchpoints::SpaceCPU, address, Watchpoints::AccessWrite))
+        m_pWatchpoints->Check(Watchpoints::SpaceCPU, address, value, Watchpoints::AccessWrite);
+#endif
     m_pCurrentMemoryRule->PerformWrite(address, value);
+
+    if (m_ProActionReplayPages[address >> 8] != 0)
+        ProActionReplayTrap(address);
 }
 
 inline u8 Memory::Retrieve(u16 address)
@@ -50,5 +77,29 @@ inline Memory::stDisassembleRecord** Memory::GetDisassembledROMMemoryMap()
     return m_pDisassembledROMMap;
 }
 
+inline bool Memory::IsBreakpoint(stDisassembleRecord* pRecord)
+{
+    return !m_Breakpoints.empty() && m_BreakpointBits[GetBreakpointIndex(pRecord)];
+}
+
+inline u32 Memory::GetDisassemblyRevision()
+{
+    return m_iDisassemblyRevision;
+}
+
+inline void Memory::UpdateDisassemblyRevision()
+{
+    m_iDisassemblyRevision++;
+}
+
+inline int Memory::GetBreakpointIndex(stDisassembleRecord* pRecord)
+{
+    // ROM records are indexed by ROM offset, RAM records go after them
+    if (pRecord->address >= 0xC000)
+        return MAX_ROM_SIZE + (pRecord->address & 0x3FFF);
+    else
+        return (0x4000 * pRecord->bank) + (pRecord->address & 0x3FFF);
+}
+
 #endif	/* MEMORY_INLINE_H */
 
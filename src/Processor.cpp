@@ -28,6 +28,13 @@ Processor::Processor(Memory* pMemory)
 {
     m_pMemory = pMemory;
     InitPointer(m_pIOPorts);
+    InitPointer(m_pTracer);
+    InitPointer(m_pTraceRecord);
+    m_iDisassembledAddress = -1;
+    m_DisassembledBank = 0;
+    InitPointer(m_pWatchpoints);
+    m_bFrameStats = false;
+    m_bIOInstruction = false;
     InitOPCodeFunctors();
     m_bIFF1 = false;
     m_bIFF2 = false;
@@ -41,7 +48,6 @@ Processor::Processor(Memory* pMemory)
     m_bPrefixedCBOpcode = false;
     m_PrefixedCBValue = 0;
     m_bInputLastCycle = false;
-    m_ProActionReplayList.clear();
     m_bBreakpointHit = false;
 
     m_ProcessorState.AF = &AF;
@@ -104,8 +110,9 @@ void Processor::Reset()
     m_bPrefixedCBOpcode = false;
     m_PrefixedCBValue = 0;
     m_bInputLastCycle = false;
-    m_ProActionReplayList.clear();
     m_bBreakpointHit = false;
+    m_iDisassembledAddress = -1;
+    ResetFrameStats();
 }
 
 void Processor::SetIOPOrts(IOPorts* pIOPorts)
@@ -118,11 +125,66 @@ IOPorts* Processor::GetIOPOrts()
     return m_pIOPorts;
 }
 
+void Processor::SetTracer(Tracer* pTracer)
+{
+    m_pTracer = pTracer;
+}
+
+void Processor::SetWatchpoints(Watchpoints* pWatchpoints)
+{
+    m_pWatchpoints = pWatchpoints;
+}
+
+// The opcode is filled in by TraceOPCode() once it has been fetched, and the
+// bank is the one the disassembler already resolved for this address
+inline Tracer::Record* Processor::BeginTrace()
+{
+    Tracer::Record* record = m_pTracer->BeginRecord();
+    u16 pc = PC.GetValue();
+
+    record->pc = pc;
+    if (pc >= 0xC000)
+        record->bank = 0xFF;
+    else if (pc == m_iDisassembledAddress)
+        record->bank = m_DisassembledBank;
+    else
+        record->bank = static_cast<u8>(m_pMemory->GetCurrentRule()->GetBank(pc >> 14));
+    record->af = AF.GetValue();
+    record->bc = BC.GetValue();
+    record->de = DE.GetValue();
+    record->hl = HL.GetValue();
+    record->ix = IX.GetValue();
+    record->iy = IY.GetValue();
+    record->sp = SP.GetValue();
+
+    m_pTraceRecord = record;
+
+    return record;
+}
+
+// Only the bytes of the instruction are read, prefixed ones take all 4
+void Processor::TraceOPCode(u8 opcode)
+{
+    Tracer::Record* record = m_pTraceRecord;
+    u16 pc = record->pc;
+    bool prefixed = (opcode == 0xCB) || (opcode == 0xDD) || (opcode == 0xED) || (opcode == 0xFD);
+    int size = prefixed ? 4 : kOPCodeNames[opcode].size;
+
+    record->bytes[0] = opcode;
+    record->bytes[1] = (size > 1) ? m_pMemory->Peek(pc + 1) : 0;
+    record->bytes[2] = (size > 2) ? m_pMemory->Peek(pc + 2) : 0;
+    record->bytes[3] = (size > 3) ? m_pMemory->Peek(pc + 3) : 0;
+
+    InitPointer(m_pTraceRecord);
+}
+
 unsigned int Processor::Tick()
 {
     m_iTStates = 0;
     m_bBreakpointHit = false;
 
+    Tracer::Record* trace = (IsValidPointer(m_pTracer) && m_pTracer->IsEnabled()) ? BeginTrace() : NULL;
+
     if (!m_bInputLastCycle)
     {
         if (m_bNMIRequested)
@@ -135,6 +197,13 @@ unsigned int Processor::Tick()
             m_iTStates += 11;
             IncreaseR();
             WZ.SetValue(PC.GetValue());
+            if (m_bFrameStats)
+                EnterInterruptStats(true);
+            if (IsValidPointer(trace))
+            {
+                TraceOPCode(m_pMemory->Peek(trace->pc));
+                m_pTracer->EndRecord(trace, Tracer::RecordNMI, m_iTStates);
+            }
             return m_iTStates;
         }
         else if (m_bIFF1 && m_bINTRequested && !m_bAfterEI)
@@ -147,7 +216,13 @@ unsigned int Processor::Tick()
             m_iTStates += 13;
             IncreaseR();
             WZ.SetValue(PC.GetValue());
-            UpdateProActionReplay();
+            if (m_bFrameStats)
+                EnterInterruptStats(false);
+            if (IsValidPointer(trace))
+            {
+                TraceOPCode(m_pMemory->Peek(trace->pc));
+                m_pTracer->EndRecord(trace, Tracer::RecordINT, m_iTStates);
+            }
             return m_iTStates;
         }
 
@@ -156,15 +231,28 @@ unsigned int Processor::Tick()
 
     ExecuteOPCode();
 
+    if (m_bFrameStats)
+        UpdateFrameStats();
+
     #ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
     m_bBreakpointHit = Disassemble(PC.GetValue());
+
+    if (IsValidPointer(m_pWatchpoints) && m_pWatchpoints->ConsumeHit())
+        m_bBreakpointHit = true;
     #endif
 
+    if (IsValidPointer(trace))
+        m_pTracer->EndRecord(trace, Tracer::RecordInstruction, m_iTStates);
+
     return m_iTStates;
 }
 
-void Processor::RequestINT(bool assert)
+// Late is how many cycles ago the line went low, within the last Tick
+void Processor::RequestINT(bool assert, unsigned int late)
 {
+    if (assert && !m_bINTRequested)
+        m_INTRequestClock = m_iStatsClock - std::min<u64>(late, m_iStatsClock);
+
     m_bINTRequested = assert;
 }
 
@@ -177,6 +265,9 @@ void Processor::ExecuteOPCode()
 {
     u8 opcode = FetchOPCode();
 
+    if (IsValidPointer(m_pTraceRecord))
+        TraceOPCode(opcode);
+
     switch (opcode)
     {
         case 0xDD:
@@ -210,7 +301,7 @@ void Processor::ExecuteOPCode()
             if (IsPrefixedInstruction())
             {
                 m_bPrefixedCBOpcode = true;
-                m_PrefixedCBValue = m_pMemory->Read(PC.GetValue());
+                m_PrefixedCBValue = m_pMemory->FetchRead(PC.GetValue());
                 PC.Increment();
             }
             else
@@ -270,24 +361,24 @@ void Processor::InvalidOPCode()
 #ifdef DEBUG_GEARSYSTEM
     u16 opcode_address = PC.GetValue() - 1;
     u16 prefix_address = PC.GetValue() - 2;
-    u8 opcode = m_pMemory->Read(opcode_address);
-    u8 prefix = m_pMemory->Read(prefix_address);
+    u8 opcode = m_pMemory->Peek(opcode_address);
+    u8 prefix = m_pMemory->Peek(prefix_address);
 
     switch (prefix)
     {
         case 0xCB:
         {
-            Log("--> ** INVALID CB OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeCBNames[opcode]);
+            Log_Warning("--> ** INVALID CB OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeCBNames[opcode]);
             break;
         }
         case 0xED:
         {
-            Log("--> ** INVALID ED OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeEDNames[opcode]);
+            Log_Warning("--> ** INVALID ED OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeEDNames[opcode]);
             break;
         }
         default:
         {
-            Log("--> ** INVALID OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeNames[opcode]);
+            Log_Warning("--> ** INVALID OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeNames[opcode]);
         }
     }
 #endif
@@ -297,9 +388,9 @@ void Processor::UndocumentedOPCode()
 {
 #ifdef DEBUG_GEARSYSTEM
     u16 opcode_address = PC.GetValue() - 1;
-    u8 opcode = m_pMemory->Read(opcode_address);
+    u8 opcode = m_pMemory->Peek(opcode_address);
 
-    Log("--> ** UNDOCUMENTED OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeNames[opcode]);
+    Log_Debug("--> ** UNDOCUMENTED OP Code (%X) at $%.4X -- %s", opcode, opcode_address, kOPCodeNames[opcode]);
 #endif
 }
 
@@ -308,6 +399,12 @@ bool Processor::Disassemble(u16 address)
     Memory::stDisassembleRecord** memoryMap = m_pMemory->GetDisassembledMemoryMap();
     Memory::stDisassembleRecord** romMap = m_pMemory->GetDisassembledROMMemoryMap();
 
+    if (!IsValidPointer(memoryMap) || !IsValidPointer(romMap))
+    {
+        m_iDisassembledAddress = -1;
+        return false;
+    }
+
     Memory::stDisassembleRecord** map = NULL;
 
     int offset = address;
@@ -339,6 +436,9 @@ bool Processor::Disassemble(u16 address)
         rom = false;
     }
 
+    m_iDisassembledAddress = address;
+    m_DisassembledBank = static_cast<u8>(bank);
+
     if (!IsValidPointer(map[offset]))
     {
         map[offset] = new Memory::stDisassembleRecord;
@@ -366,63 +466,19 @@ bool Processor::Disassemble(u16 address)
 
         std::vector<u8> bytes; 
         u16 opcode_temp_addr = address;
-        u8 opcode_temp = m_pMemory->Read(opcode_temp_addr);
-        u8 ddfd_mod = 0;
-        int first = 0;
+        u8 opcode_temp = m_pMemory->Peek(opcode_temp_addr);
 
         while ((opcode_temp == 0xDD) || (opcode_temp == 0xFD))
         {
-            ddfd_mod = opcode_temp;
             bytes.push_back(opcode_temp);
             opcode_temp_addr++;
-            first++;
-            opcode_temp = m_pMemory->Read(opcode_temp_addr);
+            opcode_temp = m_pMemory->Peek(opcode_temp_addr);
         }
 
         for (int i = 0; i < 5; i++)
-            bytes.push_back(m_pMemory->Read(opcode_temp_addr + i));
-
-        u8 opcode = bytes[first];
-        stOPCodeInfo info;
-
-        bool prefixed = false;
-
-        if (opcode == 0xCB)
-        {
-            prefixed = true;
-            if (ddfd_mod == 0xDD)
-            {
-                opcode = bytes[first + 2];
-                info = kOPCodeDDCBNames[opcode];
-            }
-            else if (ddfd_mod == 0xFD)
-            {
-                opcode = bytes[first + 2];
-                info = kOPCodeFDCBNames[opcode];
-            }
-            else
-            {
-                opcode = bytes[first + 1];
-                info = kOPCodeCBNames[opcode];
-            }
-        }
-        else if (opcode == 0xED)
-        {
-            prefixed = true;
-            opcode = bytes[first + 1];
-            info = kOPCodeEDNames[opcode];
-        }
-        else
-        {
-            if (ddfd_mod == 0xDD)
-                info = kOPCodeDDNames[opcode];
-            else if (ddfd_mod == 0xFD)
-                info = kOPCodeFDNames[opcode];
-            else
-                info = kOPCodeNames[opcode];
-        }
+            bytes.push_back(m_pMemory->Peek(opcode_temp_addr + i));
 
-        map[offset]->size = info.size + (first > 1 ? (first - 1) : 0);
+        map[offset]->size = FormatOPCode(&bytes[0], address, map[offset]->name);
         map[offset]->bytes[0] = 0;
 
         for (int i = 0; i < (int)bytes.size(); i++)
@@ -440,38 +496,10 @@ bool Processor::Disassemble(u16 address)
             }
         }
 
-        first += prefixed ? 1 : 0;
-
-        switch (info.type)
-        {
-            case 0:
-                strcpy(map[offset]->name, info.name);
-                break;
-            case 1:
-                sprintf(map[offset]->name, info.name, bytes[first]);
-                break;
-            case 2:
-                sprintf(map[offset]->name, info.name, bytes[first + 1]);
-                break;
-            case 3:
-                sprintf(map[offset]->name, info.name, (bytes[first + 2] << 8) | bytes[first + 1]);
-                break;
-            case 4:
-                sprintf(map[offset]->name, info.name, (s8)bytes[first + 1]);
-                break;
-            case 5:
-                sprintf(map[offset]->name, info.name, address + info.size + (s8)bytes[first + 1], (s8)bytes[first + 1]);
-                break;
-            case 6:
-                sprintf(map[offset]->name, info.name, (s8)bytes[first + 1], bytes[first + 2]);
-                break;
-            default:
-                strcpy(map[offset]->name, "PARSE ERROR");
-        }
+        m_pMemory->UpdateDisassemblyRevision();
     }
 
     Memory::stDisassembleRecord* runtobreakpoint = m_pMemory->GetRunToBreakpoint();
-    std::vector<Memory::stDisassembleRecord*>* breakpoints = m_pMemory->GetBreakpoints();
 
     if (IsValidPointer(runtobreakpoint))
     {
@@ -483,18 +511,8 @@ bool Processor::Disassemble(u16 address)
         else
             return false;
     }
-    else
-    {
-        for (long unsigned int b = 0; b < breakpoints->size(); b++)
-        {
-            if ((*breakpoints)[b] == map[offset])
-            {
-                return true;
-            }
-        }
-    }
 
-    return false;
+    return m_pMemory->IsBreakpoint(map[offset]);
 }
 
 bool Processor::BreakpointHit()
@@ -507,6 +525,66 @@ bool Processor::Halted()
     return m_bHalt;
 }
 
+void Processor::EnableFrameStats(bool enable)
+{
+    if (enable && !m_bFrameStats)
+        ResetFrameStats();
+
+    m_bFrameStats = enable;
+}
+
+bool Processor::IsFrameStatsEnabled()
+{
+    return m_bFrameStats;
+}
+
+void Processor::EndFrameStats(FrameStats& stats)
+{
+    stats = m_FrameStats;
+
+    if (stats.int_count == 0)
+        stats.int_latency_min = 0;
+
+    m_FrameStats = FrameStats();
+    m_FrameStats.int_latency_min = 0xFFFFFFFF;
+}
+
+void Processor::ResetFrameStats()
+{
+    m_FrameStats = FrameStats();
+    m_FrameStats.int_latency_min = 0xFFFFFFFF;
+    m_iStatsClock = 0;
+    m_INTRequestClock = 0;
+    m_iHandlerDepth = 0;
+    m_bIOInstruction = false;
+}
+
+void Processor::EnterInterruptStats(bool nmi)
+{
+    if (nmi)
+        m_FrameStats.nmi_count++;
+    else
+    {
+        u32 latency = static_cast<u32>(m_iStatsClock - m_INTRequestClock);
+        m_FrameStats.int_count++;
+        m_FrameStats.int_latency_total += latency;
+        m_FrameStats.int_latency_min = std::min(m_FrameStats.int_latency_min, latency);
+        m_FrameStats.int_latency_max = std::max(m_FrameStats.int_latency_max, latency);
+
+        // A line that is never acknowledged is measured again from here
+        m_INTRequestClock = m_iStatsClock + m_iTStates;
+    }
+
+    // The handler is left once the stack unwinds past the pushed PC, this
+    // catches RETI, RETN and also handlers that exit with RET or reset SP
+    if (m_iHandlerDepth < GS_HANDLER_DEPTH)
+        m_HandlerSP[m_iHandlerDepth++] = SP.GetValue();
+
+    m_FrameStats.cycles += m_iTStates;
+    m_FrameStats.interrupt_cycles += m_iTStates;
+    m_iStatsClock += m_iTStates;
+}
+
 void Processor::SaveState(std::ostream& stream)
 {
     using namespace std;
@@ -610,6 +688,41 @@ void Processor::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (&m_bPrefixedCBOpcode), sizeof(m_bPrefixedCBOpcode));
     stream.read(reinterpret_cast<char*> (&m_PrefixedCBValue), sizeof(m_PrefixedCBValue));
     stream.read(reinterpret_cast<char*> (&m_bInputLastCycle), sizeof(m_bInputLastCycle));
+    m_iDisassembledAddress = -1;
+}
+
+void Processor::CopyState(const Processor* pSource)
+{
+    AF.SetValue(pSource->AF.GetValue());
+    BC.SetValue(pSource->BC.GetValue());
+    DE.SetValue(pSource->DE.GetValue());
+    HL.SetValue(pSource->HL.GetValue());
+    AF2.SetValue(pSource->AF2.GetValue());
+    BC2.SetValue(pSource->BC2.GetValue());
+    DE2.SetValue(pSource->DE2.GetValue());
+    HL2.SetValue(pSource->HL2.GetValue());
+    SP.SetValue(pSource->SP.GetValue());
+    PC.SetValue(pSource->PC.GetValue());
+    IX.SetValue(pSource->IX.GetValue());
+    IY.SetValue(pSource->IY.GetValue());
+    WZ.SetValue(pSource->WZ.GetValue());
+    I.SetValue(pSource->I.GetValue());
+    R.SetValue(pSource->R.GetValue());
+
+    m_bIFF1 = pSource->m_bIFF1;
+    m_bIFF2 = pSource->m_bIFF2;
+    m_bHalt = pSource->m_bHalt;
+    m_bBranchTaken = pSource->m_bBranchTaken;
+    m_iTStates = pSource->m_iTStates;
+    m_bAfterEI = pSource->m_bAfterEI;
+    m_iInterruptMode = pSource->m_iInterruptMode;
+    m_CurrentPrefix = pSource->m_CurrentPrefix;
+    m_bINTRequested = pSource->m_bINTRequested;
+    m_bNMIRequested = pSource->m_bNMIRequested;
+    m_bPrefixedCBOpcode = pSource->m_bPrefixedCBOpcode;
+    m_PrefixedCBValue = pSource->m_PrefixedCBValue;
+    m_bInputLastCycle = pSource->m_bInputLastCycle;
+    m_iDisassembledAddress = -1;
 }
 
 void Processor::SetProActionReplayCheat(const char* szCheat)
@@ -620,28 +733,16 @@ void Processor::SetProActionReplayCheat(const char* szCheat)
 
     if (code.length() == 9)
     {
-        ProActionReplayCode par;
-
-        par.value = (AsHex(code[7]) << 4 | AsHex(code[8])) & 0xFF;
-        par.address = ((AsHex(code[2]) << 12) | (AsHex(code[3]) << 8) | (AsHex(code[5]) << 4) | AsHex(code[6])) & 0xFFFF;
+        u8 value = (AsHex(code[7]) << 4 | AsHex(code[8])) & 0xFF;
+        u16 address = ((AsHex(code[2]) << 12) | (AsHex(code[3]) << 8) | (AsHex(code[5]) << 4) | AsHex(code[6])) & 0xFFFF;
 
-        m_ProActionReplayList.push_back(par);
+        m_pMemory->AddProActionReplayCode(address, value);
     }
 }
 
 void Processor::ClearProActionReplayCheats()
 {
-    m_ProActionReplayList.clear();
-}
-
-void Processor::UpdateProActionReplay()
-{
-    std::list<ProActionReplayCode>::iterator it;
-
-    for (it = m_ProActionReplayList.begin(); it != m_ProActionReplayList.end(); it++)
-    {
-        m_pMemory->Write(it->address, it->value);
-    }
+    m_pMemory->ClearProActionReplayCodes();
 }
 
 Processor::ProcessorState* Processor::GetState()
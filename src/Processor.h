@@ -20,10 +20,13 @@
 #ifndef PROCESSOR_H
 #define	PROCESSOR_H
 
-#include <list>
 #include "definitions.h"
 #include "SixteenBitRegister.h"
 #include "Memory.h"
+#include "Tracer.h"
+#include "Watchpoints.h"
+
+#define GS_HANDLER_DEPTH 4
 
 class IOPorts;
 
@@ -54,24 +57,44 @@ public:
         bool* NMI;
     };
 
+    struct FrameStats
+    {
+        u32 cycles;
+        u32 halt_cycles;
+        u32 interrupt_cycles;
+        u32 io_cycles;
+        u32 code_cycles;
+        u32 int_count;
+        u32 nmi_count;
+        u32 int_latency_min;
+        u32 int_latency_max;
+        u32 int_latency_total;
+    };
+
 public:
     Processor(Memory* pMemory);
     ~Processor();
     void Init();
     void Reset();
     unsigned int Tick();
-    void RequestINT(bool assert);
+    void RequestINT(bool assert, unsigned int late = 0);
     void RequestNMI();
     void SetIOPOrts(IOPorts* pIOPorts);
     IOPorts* GetIOPOrts();
+    void SetTracer(Tracer* pTracer);
+    void SetWatchpoints(Watchpoints* pWatchpoints);
     void SaveState(std::ostream& stream);
     void LoadState(std::istream& stream);
+    void CopyState(const Processor* pSource);
     void SetProActionReplayCheat(const char* szCheat);
     void ClearProActionReplayCheats();
     ProcessorState* GetState();
     bool Disassemble(u16 address);
     bool BreakpointHit();
     bool Halted();
+    void EnableFrameStats(bool enable);
+    bool IsFrameStatsEnabled();
+    void EndFrameStats(FrameStats& stats);
 
 private:
     typedef void (Processor::*OPCptr) (void);
@@ -109,21 +132,33 @@ private:
     u8 m_PrefixedCBValue;
     bool m_bInputLastCycle;
     bool m_bBreakpointHit;
-
-    struct ProActionReplayCode
-    {
-        u16 address;
-        u8 value;
-    };
-    std::list<ProActionReplayCode> m_ProActionReplayList;
+    Tracer* m_pTracer;
+    Tracer::Record* m_pTraceRecord;
+    int m_iDisassembledAddress;
+    u8 m_DisassembledBank;
+    Watchpoints* m_pWatchpoints;
+    bool m_bFrameStats;
+    bool m_bIOInstruction;
+    FrameStats m_FrameStats;
+    u64 m_iStatsClock;
+    u64 m_INTRequestClock;
+    u16 m_HandlerSP[GS_HANDLER_DEPTH];
+    int m_iHandlerDepth;
 
     ProcessorState m_ProcessorState;
 
 private:
     u8 FetchOPCode();
+    Tracer::Record* BeginTrace();
+    void TraceOPCode(u8 opcode);
     u16 FetchArg16();
+    u8 PortInput(u8 port);
+    void PortOutput(u8 port, u8 value);
     void ExecuteOPCode();
     void LeaveHalt();
+    void UpdateFrameStats();
+    void EnterInterruptStats(bool nmi);
+    void ResetFrameStats();
     void ClearAllFlags();
     void ToggleZeroFlagFromResult(u16 result);
     void ToggleSignFlagFromResult(u8 result);
@@ -138,7 +173,6 @@ private:
     void StackPop(SixteenBitRegister* reg);
     void SetInterruptMode(int mode);
     void IncreaseR();
-    void UpdateProActionReplay();
     void InvalidOPCode();
     void UndocumentedOPCode();
     SixteenBitRegister* GetPrefixedRegister();
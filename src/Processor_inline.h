@@ -27,7 +27,7 @@
 
 inline u8 Processor::FetchOPCode()
 {
-    u8 opcode = m_pMemory->Read(PC.GetValue());
+    u8 opcode = m_pMemory->FetchRead(PC.GetValue());
     PC.Increment();
     return opcode;
 }
@@ -35,12 +35,54 @@ inline u8 Processor::FetchOPCode()
 inline u16 Processor::FetchArg16()
 {
     u16 pc = PC.GetValue();
-    u8 l = m_pMemory->Read(pc);
-    u8 h = m_pMemory->Read(pc + 1);
+    u8 l = m_pMemory->FetchRead(pc);
+    u8 h = m_pMemory->FetchRead(pc + 1);
     PC.SetValue(pc + 2);
     return (h << 8) | l;
 }
 
+inline u8 Processor::PortInput(u8 port)
+{
+    m_bIOInstruction = true;
+    u8 value = m_pIOPorts->DoInput(port);
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+    if (IsValidPointer(m_pWatchpoints) && m_pWatchpoints->IsWatched(Watchpoints::SpaceIO, port, Watchpoints::AccessRead))
+        m_pWatchpoints->Check(Watchpoints::SpaceIO, port, value, Watchpoints::AccessRead);
+#endif
+    return value;
+}
+
+inline void Processor::PortOutput(u8 port, u8 value)
+{
+    m_bIOInstruction = true;
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+    if (IsValidPointer(m_pWatchpoints) && m_pWatchpoints->IsWatched(Watchpoints::SpaceIO, port, Watchpoints::AccessWrite))
+        m_pWatchpoints->Check(Watchpoints::SpaceIO, port, value, Watchpoints::AccessWrite);
+#endif
+    m_pIOPorts->DoOutput(port, value);
+}
+
+inline void Processor::UpdateFrameStats()
+{
+    if (m_bHalt)
+        m_FrameStats.halt_cycles += m_iTStates;
+    else if (m_iHandlerDepth > 0)
+    {
+        m_FrameStats.interrupt_cycles += m_iTStates;
+
+        while ((m_iHandlerDepth > 0) && (SP.GetValue() > m_HandlerSP[m_iHandlerDepth - 1]))
+            m_iHandlerDepth--;
+    }
+    else if (m_bIOInstruction)
+        m_FrameStats.io_cycles += m_iTStates;
+    else
+        m_FrameStats.code_cycles += m_iTStates;
+
+    m_bIOInstruction = false;
+    m_FrameStats.cycles += m_iTStates;
+    m_iStatsClock += m_iTStates;
+}
+
 inline void Processor::LeaveHalt()
 {
     if (m_bHalt)
@@ -140,7 +182,7 @@ inline void Processor::SetInterruptMode(int mode)
     }
     else
     {
-        Log("--> ** Attempting to set interrupt mode %d", mode);
+        Log_Warning("--> ** Attempting to set interrupt mode %d", mode);
     }
 }
 
@@ -170,7 +212,7 @@ inline u16 Processor::GetEffectiveAddress()
             }
             else
             {
-                address += static_cast<s8> (m_pMemory->Read(PC.GetValue()));
+                address += static_cast<s8> (m_pMemory->FetchRead(PC.GetValue()));
                 PC.Increment();
                 WZ.SetValue(address);
             }
@@ -185,7 +227,7 @@ inline u16 Processor::GetEffectiveAddress()
             }
             else
             {
-                address += static_cast<s8> (m_pMemory->Read(PC.GetValue()));
+                address += static_cast<s8> (m_pMemory->FetchRead(PC.GetValue()));
                 PC.Increment();
                 WZ.SetValue(address);
             }
@@ -317,8 +359,8 @@ inline void Processor::OPCodes_CALL_nn_Conditional(bool condition)
 
 inline void Processor::OPCodes_JP_nn()
 {
-    u8 l = m_pMemory->Read(PC.GetValue());
-    u8 h = m_pMemory->Read(PC.GetValue() + 1);
+    u8 l = m_pMemory->FetchRead(PC.GetValue());
+    u8 h = m_pMemory->FetchRead(PC.GetValue() + 1);
     u16 address = (h << 8) | l;
     PC.SetValue(address);
     WZ.SetValue(address);
@@ -326,8 +368,8 @@ inline void Processor::OPCodes_JP_nn()
 
 inline void Processor::OPCodes_JP_nn_Conditional(bool condition)
 {
-    u8 l = m_pMemory->Read(PC.GetValue());
-    u8 h = m_pMemory->Read(PC.GetValue() + 1);
+    u8 l = m_pMemory->FetchRead(PC.GetValue());
+    u8 h = m_pMemory->FetchRead(PC.GetValue() + 1);
     u16 address = (h << 8) | l;
     if (condition)
     {
@@ -345,7 +387,7 @@ inline void Processor::OPCodes_JP_nn_Conditional(bool condition)
 inline void Processor::OPCodes_JR_n()
 {
     u16 pc = PC.GetValue();
-    PC.SetValue(pc + 1 + (static_cast<s8> (m_pMemory->Read(pc))));
+    PC.SetValue(pc + 1 + (static_cast<s8> (m_pMemory->FetchRead(pc))));
 }
 
 inline void Processor::OPCodes_JR_n_conditional(bool condition)
@@ -376,7 +418,7 @@ inline void Processor::OPCodes_RET_Conditional(bool condition)
 
 inline void Processor::OPCodes_IN_C(EightBitRegister* reg)
 {
-    u8 result = m_pIOPorts->DoInput(BC.GetLow());
+    u8 result = PortInput(BC.GetLow());
     if (IsValidPointer(reg))
         reg->SetValue(result);
     IsSetFlag(FLAG_CARRY) ? SetFlag(FLAG_CARRY) : ClearAllFlags();
@@ -389,7 +431,7 @@ inline void Processor::OPCodes_IN_C(EightBitRegister* reg)
 inline void Processor::OPCodes_INI()
 {
     WZ.SetValue(BC.GetValue() + 1);
-    u8 result = m_pIOPorts->DoInput(BC.GetLow());
+    u8 result = PortInput(BC.GetLow());
     m_pMemory->Write(HL.GetValue(), result);
     OPCodes_DEC(BC.GetHighRegister());
     HL.Increment();
@@ -416,7 +458,7 @@ inline void Processor::OPCodes_INI()
 inline void Processor::OPCodes_IND()
 {
     WZ.SetValue(BC.GetValue() - 1);
-    u8 result = m_pIOPorts->DoInput(BC.GetLow());
+    u8 result = PortInput(BC.GetLow());
     m_pMemory->Write(HL.GetValue(), result);
     OPCodes_DEC(BC.GetHighRegister());
     HL.Decrement();
@@ -442,13 +484,13 @@ inline void Processor::OPCodes_IND()
 
 inline void Processor::OPCodes_OUT_C(EightBitRegister* reg)
 {
-    m_pIOPorts->DoOutput(BC.GetLow(), reg->GetValue());
+    PortOutput(BC.GetLow(), reg->GetValue());
 }
 
 inline void Processor::OPCodes_OUTI()
 {
     u8 result = m_pMemory->Read(HL.GetValue());
-    m_pIOPorts->DoOutput(BC.GetLow(), result);
+    PortOutput(BC.GetLow(), result);
     OPCodes_DEC(BC.GetHighRegister());
     WZ.SetValue(BC.GetValue() + 1);
     HL.Increment();
@@ -475,7 +517,7 @@ inline void Processor::OPCodes_OUTI()
 inline void Processor::OPCodes_OUTD()
 {
     u8 result = m_pMemory->Read(HL.GetValue());
-    m_pIOPorts->DoOutput(BC.GetLow(), result);
+    PortOutput(BC.GetLow(), result);
     OPCodes_DEC(BC.GetHighRegister());
     WZ.SetValue(BC.GetValue() - 1);
     HL.Decrement();
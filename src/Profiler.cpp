@@ -0,0 +1,325 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include "Profiler.h"
+#include "Cartridge.h"
+
+static bool CompareHotSpots(const Profiler::HotSpot& a, const Profiler::HotSpot& b)
+{
+    return a.cycles > b.cycles;
+}
+
+Profiler::Profiler(Memory* pMemory, Cartridge* pCartridge)
+{
+    m_pMemory = pMemory;
+    m_pCartridge = pCartridge;
+    InitPointer(m_pCycles);
+    m_iROMSize = 0;
+    m_iSize = 0;
+    m_iTotalCycles = 0;
+}
+
+Profiler::~Profiler()
+{
+    SafeDeleteArray(m_pCycles);
+}
+
+void Profiler::Enable(bool enable)
+{
+    if (enable == IsEnabled())
+        return;
+
+    if (enable)
+    {
+        Allocate();
+    }
+    else
+    {
+        SafeDeleteArray(m_pCycles);
+        m_iTotalCycles = 0;
+    }
+}
+
+void Profiler::Clear()
+{
+    // The ROM may have changed, the counters are resized if needed
+    if (IsEnabled())
+        Allocate();
+}
+
+void Profiler::Allocate()
+{
+    int rom_size = (m_pCartridge->GetROMSize() + 0x3FFF) & ~0x3FFF;
+
+    // One counter per ROM byte, 8KB of RAM and a last one for unmapped
+    // banks and cartridge RAM
+    int size = rom_size + 0x2000 + 1;
+
+    if (!IsValidPointer(m_pCycles) || (size != m_iSize))
+    {
+        SafeDeleteArray(m_pCycles);
+        m_pCycles = new u64[size];
+    }
+
+    m_iROMSize = rom_size;
+    m_iSize = size;
+    m_iTotalCycles = 0;
+
+    for (int i = 0; i < m_iSize; i++)
+        m_pCycles[i] = 0;
+}
+
+u64 Profiler::GetTotalCycles()
+{
+    return m_iTotalCycles;
+}
+
+void Profiler::AddSymbol(int bank, u16 address, const char* szName)
+{
+    int key;
+
+    if (address >= 0xC000)
+        key = MAX_ROM_SIZE + (address & 0x1FFF);
+    else
+        key = (0x4000 * bank) + (address & 0x3FFF);
+
+    m_Symbols[key] = szName;
+}
+
+void Profiler::ClearSymbols()
+{
+    m_Symbols.clear();
+}
+
+void Profiler::GetHotSpots(std::vector<HotSpot>& hotSpots)
+{
+    hotSpots.clear();
+
+    if (!IsEnabled())
+        return;
+
+    for (int i = 0; i < m_iSize; i++)
+    {
+        if (m_pCycles[i] == 0)
+            continue;
+
+        HotSpot spot;
+        int key = GetSymbolKey(i);
+        GetLocation(key, spot.bank, spot.address);
+        spot.cycles = m_pCycles[i];
+
+        SymbolMap::const_iterator symbol = FindSymbol(key);
+        if (symbol != m_Symbols.end())
+            spot.symbol = symbol->second;
+
+        hotSpots.push_back(spot);
+    }
+
+    std::sort(hotSpots.begin(), hotSpots.end(), CompareHotSpots);
+}
+
+void Profiler::GetSymbolHotSpots(std::vector<HotSpot>& hotSpots)
+{
+    hotSpots.clear();
+
+    if (!IsEnabled())
+        return;
+
+    // Cycles outside any symbol are grouped by bank
+    std::map<int, HotSpot> groups;
+
+    for (int i = 0; i < m_iSize; i++)
+    {
+        if (m_pCycles[i] == 0)
+            continue;
+
+        int key = GetSymbolKey(i);
+        SymbolMap::const_iterator symbol = FindSymbol(key);
+        bool found = (symbol != m_Symbols.end());
+        int group_key = found ? symbol->first : ((key < 0) ? -1 : (key & ~0x3FFF));
+
+        std::map<int, HotSpot>::iterator group = groups.find(group_key);
+
+        if (group == groups.end())
+        {
+            HotSpot spot;
+            GetLocation(group_key, spot.bank, spot.address);
+            spot.cycles = 0;
+            if (found)
+                spot.symbol = symbol->second;
+            group = groups.insert(std::make_pair(group_key, spot)).first;
+        }
+
+        group->second.cycles += m_pCycles[i];
+    }
+
+    for (std::map<int, HotSpot>::const_iterator it = groups.begin(); it != groups.end(); ++it)
+        hotSpots.push_back(it->second);
+
+    std::sort(hotSpots.begin(), hotSpots.end(), CompareHotSpots);
+}
+
+bool Profiler::SaveCSV(const char* szFilePath)
+{
+    using namespace std;
+
+    ofstream file(szFilePath, ios::out | ios::trunc);
+
+    if (!file.is_open())
+    {
+        Log_Error("Unable to save profile %s", szFilePath);
+        return false;
+    }
+
+    std::vector<HotSpot> hotSpots;
+    GetHotSpots(hotSpots);
+
+    char line[64];
+    double total = (m_iTotalCycles > 0) ? static_cast<double>(m_iTotalCycles) : 1.0;
+
+    file << "bank,address,cycles,percent,symbol\n";
+
+    for (size_t i = 0; i < hotSpots.size(); i++)
+    {
+        const HotSpot& spot = hotSpots[i];
+
+        snprintf(line, sizeof(line), "%02X,%04X,%llu,%.4f,", spot.bank & 0xFF, spot.address, (unsigned long long)spot.cycles, (spot.cycles * 100.0) / total);
+        file << line;
+
+        // Symbols come from user files and may hold commas or quotes
+        if (!spot.symbol.empty())
+        {
+            file << '"';
+
+            for (size_t c = 0; c < spot.symbol.length(); c++)
+            {
+                if (spot.symbol[c] == '"')
+                    file << '"';
+                file << spot.symbol[c];
+            }
+
+            file << '"';
+        }
+
+        file << "\n";
+    }
+
+    file.close();
+
+    Log("Profile saved to %s", szFilePath);
+
+    return true;
+}
+
+bool Profiler::SaveFolded(const char* szFilePath)
+{
+    using namespace std;
+
+    ofstream file(szFilePath, ios::out | ios::trunc);
+
+    if (!file.is_open())
+    {
+        Log_Error("Unable to save profile %s", szFilePath);
+        return false;
+    }
+
+    std::vector<HotSpot> hotSpots;
+    GetHotSpots(hotSpots);
+
+    char frame[64];
+
+    // There are no call stacks, each line is bank;symbol;address
+    for (size_t i = 0; i < hotSpots.size(); i++)
+    {
+        const HotSpot& spot = hotSpots[i];
+
+        if (spot.bank < 0)
+            file << "unmapped";
+        else
+        {
+            snprintf(frame, sizeof(frame), "bank_%02X;", spot.bank);
+            file << frame;
+
+            if (!spot.symbol.empty())
+                file << spot.symbol << ";";
+
+            snprintf(frame, sizeof(frame), "%02X:%04X", spot.bank, spot.address);
+            file << frame;
+        }
+
+        file << " " << spot.cycles << "\n";
+    }
+
+    file.close();
+
+    Log("Profile saved to %s", szFilePath);
+
+    return true;
+}
+
+int Profiler::GetSymbolKey(int index)
+{
+    if (index < m_iROMSize)
+        return index;
+    else if (index < (m_iROMSize + 0x2000))
+        return MAX_ROM_SIZE + (index - m_iROMSize);
+    else
+        return -1;
+}
+
+void Profiler::GetLocation(int key, int& bank, u16& address)
+{
+    if (key < 0)
+    {
+        bank = -1;
+        address = 0;
+    }
+    else if (key >= MAX_ROM_SIZE)
+    {
+        bank = 0;
+        address = 0xC000 + (key - MAX_ROM_SIZE);
+    }
+    else
+    {
+        // Banks above 1 are shown in slot 2, as most mappers page them there
+        bank = key >> 14;
+        address = (key & 0x3FFF) | (std::min(bank, 2) << 14);
+    }
+}
+
+Profiler::SymbolMap::const_iterator Profiler::FindSymbol(int key)
+{
+    if ((key < 0) || m_Symbols.empty())
+        return m_Symbols.end();
+
+    // Closest symbol at or before the key, in the same bank
+    SymbolMap::const_iterator it = m_Symbols.upper_bound(key);
+
+    if (it == m_Symbols.begin())
+        return m_Symbols.end();
+
+    --it;
+
+    if ((it->first >> 14) != (key >> 14))
+        return m_Symbols.end();
+
+    return it;
+}
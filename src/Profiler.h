@@ -0,0 +1,104 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef PROFILER_H
+#define	PROFILER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "definitions.h"
+#include "Memory.h"
+
+class Cartridge;
+
+class Profiler
+{
+public:
+    struct HotSpot
+    {
+        int bank;
+        u16 address;
+        u64 cycles;
+        std::string symbol;
+    };
+
+public:
+    Profiler(Memory* pMemory, Cartridge* pCartridge);
+    ~Profiler();
+    void Enable(bool enable);
+    bool IsEnabled();
+    void Clear();
+    void AddCycles(u16 pc, unsigned int cycles);
+    u64 GetTotalCycles();
+    void AddSymbol(int bank, u16 address, const char* szName);
+    void ClearSymbols();
+    void GetHotSpots(std::vector<HotSpot>& hotSpots);
+    void GetSymbolHotSpots(std::vector<HotSpot>& hotSpots);
+    bool SaveCSV(const char* szFilePath);
+    bool SaveFolded(const char* szFilePath);
+
+private:
+    typedef std::map<int, std::string> SymbolMap;
+
+    void Allocate();
+    int GetSymbolKey(int index);
+    void GetLocation(int key, int& bank, u16& address);
+    SymbolMap::const_iterator FindSymbol(int key);
+
+private:
+    Memory* m_pMemory;
+    Cartridge* m_pCartridge;
+    u64* m_pCycles;
+    int m_iROMSize;
+    int m_iSize;
+    u64 m_iTotalCycles;
+    SymbolMap m_Symbols;
+};
+
+inline bool Profiler::IsEnabled()
+{
+    return IsValidPointer(m_pCycles);
+}
+
+inline void Profiler::AddCycles(u16 pc, unsigned int cycles)
+{
+    int index;
+
+    // Same ROM offset scheme as the disassembler, RAM goes after the ROM
+    if (pc >= 0xC000)
+        index = m_iROMSize + (pc & 0x1FFF);
+    else if ((pc >= 0x8000) && m_pMemory->GetCurrentRule()->IsRamEnabled())
+    {
+        // Code run from cartridge RAM has no ROM offset
+        index = m_iROMSize + 0x2000;
+    }
+    else
+    {
+        index = (0x4000 * m_pMemory->GetCurrentRule()->GetBank(pc >> 14)) + (pc & 0x3FFF);
+
+        if (index >= m_iROMSize)
+            index = m_iROMSize + 0x2000;
+    }
+
+    m_pCycles[index] += cycles;
+    m_iTotalCycles += cycles;
+}
+
+#endif	/* PROFILER_H */
@@ -21,15 +21,14 @@
 #include "Memory.h"
 #include "Cartridge.h"
 
-SegaMemoryRule::SegaMemoryRule(Memory* pMemory, Cartridge* pCartridge) : MemoryRule(pMemory, pCartridge)
+SegaMemoryRule::SegaMemoryRule(Memory* pMemory, Cartridge* pCartridge, u8* pRAMBanks) : MemoryRule(pMemory, pCartridge)
 {
-    m_pRAMBanks = new u8[0x8000];
+    m_pRAMBanks = pRAMBanks;
     Reset();
 }
 
 SegaMemoryRule::~SegaMemoryRule()
 {
-    SafeDeleteArray(m_pRAMBanks);
 }
 
 u8 SegaMemoryRule::PerformRead(u16 address)
@@ -77,7 +76,7 @@ void SegaMemoryRule::PerformWrite(u16 address, u8 value)
     if (address < 0x8000)
     {
         // ROM page 0 and 1
-        Log("--> ** Attempting to write on ROM address $%X %X", address, value);
+        Log_Debug("--> ** Attempting to write on ROM address $%X %X", address, value);
     }
     else if (address < 0xC000)
     {
@@ -89,7 +88,7 @@ void SegaMemoryRule::PerformWrite(u16 address, u8 value)
         else
         {
             // ROM page 2
-            Log("--> ** Attempting to write on ROM page 2 $%X %X", address, value);
+            Log_Debug("--> ** Attempting to write on ROM page 2 $%X %X", address, value);
         }
     }
     else if (address < 0xE000)
@@ -171,7 +170,7 @@ bool SegaMemoryRule::LoadRam(std::istream & file, s32 fileSize)
 
     if ((fileSize > 0) && (fileSize != 0x8000))
     {
-        Log("SegaMemoryRule incorrect size. Expected: 512 Found: %d", fileSize);
+        Log_Warning("SegaMemoryRule incorrect size. Expected: 512 Found: %d", fileSize);
         return false;
     }
 
@@ -213,6 +212,11 @@ int SegaMemoryRule::GetRamBank()
     return m_RAMBankStartAddress == 0x4000 ? 1 : 0;
 }
 
+bool SegaMemoryRule::IsRamEnabled()
+{
+    return m_bRAMEnabled;
+}
+
 u8* SegaMemoryRule::GetPage(int index)
 {
     switch (index)
@@ -264,3 +268,14 @@ void SegaMemoryRule::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (&m_bRAMEnabled), sizeof(m_bRAMEnabled));
     stream.read(reinterpret_cast<char*> (&m_iPersistRAM), sizeof(m_iPersistRAM));
 }
+
+void SegaMemoryRule::CopyState(const MemoryRule* pSource)
+{
+    const SegaMemoryRule* source = static_cast<const SegaMemoryRule*>(pSource);
+
+    memcpy(m_iMapperSlot, source->m_iMapperSlot, sizeof(m_iMapperSlot));
+    memcpy(m_iMapperSlotAddress, source->m_iMapperSlotAddress, sizeof(m_iMapperSlotAddress));
+    m_RAMBankStartAddress = source->m_RAMBankStartAddress;
+    m_bRAMEnabled = source->m_bRAMEnabled;
+    m_iPersistRAM = source->m_iPersistRAM;
+}
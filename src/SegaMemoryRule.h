@@ -25,7 +25,7 @@
 class SegaMemoryRule : public MemoryRule
 {
 public:
-    SegaMemoryRule(Memory* pMemory, Cartridge* pCartridge);
+    SegaMemoryRule(Memory* pMemory, Cartridge* pCartridge, u8* pRAMBanks);
     virtual ~SegaMemoryRule();
     virtual u8 PerformRead(u16 address);
     virtual void PerformWrite(u16 address, u8 value);
@@ -36,10 +36,12 @@ public:
     virtual size_t GetRamSize();
     virtual u8* GetRamBanks();
     virtual int GetRamBank();
+    virtual bool IsRamEnabled();
     virtual u8* GetPage(int index);
     virtual int GetBank(int index);
     virtual void SaveState(std::ostream& stream);
     virtual void LoadState(std::istream& stream);
+    virtual void CopyState(const MemoryRule* pSource);
 
 private:
     int m_iMapperSlot[3];
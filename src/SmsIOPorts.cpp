@@ -48,7 +48,7 @@ u8 SmsIOPorts::DoInput(u8 port)
     if (port < 0x40)
     {
         // Reads return $FF (SMS2)
-        Log("--> ** Attempting to read from port $%X", port);
+        Log_Debug("--> ** Attempting to read from port $%X", port);
         return 0xFF;
     }
     else if ((port >= 0x40) && (port < 0x80))
@@ -88,7 +88,7 @@ void SmsIOPorts::DoOutput(u8 port, u8 value)
         // Writes to odd addresses go to I/O control register.
         if ((port & 0x01) == 0x00)
         {
-            Log("--> ** Output to memory control port $%X: %X", port, value);
+            Log_Debug("--> ** Output to memory control port $%X: %X", port, value);
         }
         else
         {
@@ -121,15 +121,15 @@ void SmsIOPorts::DoOutput(u8 port, u8 value)
         // Writes have no effect.
         if ((port == 0xDE) || (port == 0xDF))
         {
-            Log("--> ** Output to keyboard port $%X: %X", port, value);
+            Log_Debug("--> ** Output to keyboard port $%X: %X", port, value);
         }
         else if ((port == 0xF0) || (port == 0xF1) || (port == 0xF2))
         {
-            Log("--> ** Output to YM2413 port $%X: %X", port, value);
+            Log_Debug("--> ** Output to YM2413 port $%X: %X", port, value);
         }
         else
         {
-            Log("--> ** Output to port $%X: %X", port, value);
+            Log_Debug("--> ** Output to port $%X: %X", port, value);
         }
     }
 #endif
@@ -150,3 +150,11 @@ void SmsIOPorts::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (&m_Port3F), sizeof(m_Port3F));
     stream.read(reinterpret_cast<char*> (&m_Port3F_HC), sizeof(m_Port3F_HC));
 }
+
+void SmsIOPorts::CopyState(const IOPorts* pSource)
+{
+    const SmsIOPorts* source = static_cast<const SmsIOPorts*>(pSource);
+
+    m_Port3F = source->m_Port3F;
+    m_Port3F_HC = source->m_Port3F_HC;
+}
@@ -37,6 +37,7 @@ public:
     virtual void DoOutput(u8 port, u8 value);
     virtual void SaveState(std::ostream& stream);
     virtual void LoadState(std::istream& stream);
+    virtual void CopyState(const IOPorts* pSource);
 private:
     Audio* m_pAudio;
     Video* m_pVideo;
@@ -0,0 +1,113 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef STATEARENA_H
+#define	STATEARENA_H
+
+#include <new>
+#include "definitions.h"
+
+#define GS_ARENA_ALIGNMENT 64
+
+// Every buffer here is plain emulation state, cloning an instance is one
+// memcpy of this block. Sizes are multiples of GS_ARENA_ALIGNMENT.
+struct GS_StateBuffers
+{
+    u8 memory_map[0x10000];
+    u8 vdp_vram[0x4000];
+    u8 vdp_cram[GS_ARENA_ALIGNMENT];
+    u8 sega_ram_banks[0x8000];
+    u8 codemasters_cart_ram[0x2000];
+    u8 vdp_info_buffer[GS_RESOLUTION_MAX_WIDTH * GS_LINES_PER_FRAME_PAL];
+};
+
+class StateArena
+{
+public:
+    StateArena();
+    ~StateArena();
+    void Init(size_t size);
+    void* Allocate(size_t size);
+    size_t GetSize() const;
+    size_t GetUsed() const;
+    static size_t Align(size_t size);
+
+private:
+    u8* m_pBlock;
+    u8* m_pBase;
+    size_t m_iSize;
+    size_t m_iUsed;
+};
+
+inline StateArena::StateArena()
+{
+    InitPointer(m_pBlock);
+    InitPointer(m_pBase);
+    m_iSize = 0;
+    m_iUsed = 0;
+}
+
+inline StateArena::~StateArena()
+{
+    SafeDeleteArray(m_pBlock);
+}
+
+inline void StateArena::Init(size_t size)
+{
+    SafeDeleteArray(m_pBlock);
+
+    m_iSize = Align(size);
+    m_iUsed = 0;
+    m_pBlock = new u8[m_iSize + GS_ARENA_ALIGNMENT];
+    m_pBase = reinterpret_cast<u8*>(Align(reinterpret_cast<size_t>(m_pBlock)));
+    memset(m_pBase, 0, m_iSize);
+}
+
+inline void* StateArena::Allocate(size_t size)
+{
+    size = Align(size);
+
+    if (m_iUsed + size > m_iSize)
+    {
+        Log_Error("State arena exhausted: %d + %d > %d", (int)m_iUsed, (int)size, (int)m_iSize);
+        return NULL;
+    }
+
+    void* ret = m_pBase + m_iUsed;
+    m_iUsed += size;
+
+    return ret;
+}
+
+inline size_t StateArena::GetSize() const
+{
+    return m_iSize;
+}
+
+inline size_t StateArena::GetUsed() const
+{
+    return m_iUsed;
+}
+
+inline size_t StateArena::Align(size_t size)
+{
+    return (size + (GS_ARENA_ALIGNMENT - 1)) & ~static_cast<size_t>(GS_ARENA_ALIGNMENT - 1);
+}
+
+#endif	/* STATEARENA_H */
@@ -0,0 +1,123 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <algorithm>
+#include "Tracer.h"
+
+Tracer::Tracer()
+{
+    InitPointer(m_pRecords);
+    m_iMask = 0;
+    m_iHead = 0;
+    m_iCount = 0;
+    m_iClock = 0;
+}
+
+Tracer::~Tracer()
+{
+    SafeDeleteArray(m_pRecords);
+}
+
+void Tracer::Enable(int size)
+{
+    // The ring size is rounded up to a power of two
+    u32 capacity = 1;
+
+    while (capacity < static_cast<u32>(size))
+        capacity <<= 1;
+
+    if (!IsValidPointer(m_pRecords) || (capacity != (m_iMask + 1)))
+    {
+        SafeDeleteArray(m_pRecords);
+        m_pRecords = new Record[capacity];
+        m_iMask = capacity - 1;
+    }
+
+    Clear();
+}
+
+void Tracer::Disable()
+{
+    SafeDeleteArray(m_pRecords);
+    m_iMask = 0;
+    Clear();
+}
+
+void Tracer::Clear()
+{
+    m_iHead = 0;
+    m_iCount = 0;
+    m_iClock = 0;
+}
+
+int Tracer::GetCount()
+{
+    return static_cast<int>(m_iCount);
+}
+
+u64 Tracer::GetClock()
+{
+    return m_iClock;
+}
+
+const Tracer::Record* Tracer::GetRecord(int index)
+{
+    u32 first = (m_iHead - m_iCount) & m_iMask;
+    return &m_pRecords[(first + index) & m_iMask];
+}
+
+bool Tracer::Save(const char* szFilePath)
+{
+    if (!IsEnabled())
+        return false;
+
+    using namespace std;
+
+    ofstream file(szFilePath, ios::out | ios::binary | ios::trunc);
+
+    if (!file.is_open())
+    {
+        Log_Error("Unable to save trace %s", szFilePath);
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(header.magic, GS_TRACE_MAGIC, sizeof(header.magic));
+    header.record_size = sizeof(Record);
+    header.count = m_iCount;
+    header.clock = m_iClock;
+
+    for (u32 i = 0; i < m_iCount; i++)
+        header.clock -= m_pRecords[i].tstates;
+
+    file.write(reinterpret_cast<const char*> (&header), sizeof(header));
+
+    // At most two runs, before and after the ring wraps
+    u32 first = (m_iHead - m_iCount) & m_iMask;
+    u32 run = std::min(m_iCount, (m_iMask + 1) - first);
+
+    file.write(reinterpret_cast<const char*> (&m_pRecords[first]), run * sizeof(Record));
+    file.write(reinterpret_cast<const char*> (&m_pRecords[0]), (m_iCount - run) * sizeof(Record));
+
+    file.close();
+
+    Log("Trace saved to %s, %d records", szFilePath, (int)m_iCount);
+
+    return true;
+}
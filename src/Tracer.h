@@ -0,0 +1,108 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef TRACER_H
+#define	TRACER_H
+
+#include "definitions.h"
+
+#define GS_TRACE_MAGIC "GSTRACE1"
+#define GS_TRACE_DEFAULT_SIZE (1 << 20)
+
+class Tracer
+{
+public:
+    enum RecordType
+    {
+        RecordInstruction,
+        RecordINT,
+        RecordNMI
+    };
+
+    // Registers are the values before the step, 24 bytes per record
+    struct Record
+    {
+        u16 pc;
+        u8 bank;
+        u8 type;
+        u8 bytes[4];
+        u16 af;
+        u16 bc;
+        u16 de;
+        u16 hl;
+        u16 ix;
+        u16 iy;
+        u16 sp;
+        u8 tstates;
+        u8 reserved;
+    };
+
+    // Dumps are this header followed by the records, oldest first, in
+    // host byte order. Clock is the cycle count of the first record.
+    struct FileHeader
+    {
+        char magic[8];
+        u32 record_size;
+        u32 count;
+        u64 clock;
+    };
+
+public:
+    Tracer();
+    ~Tracer();
+    void Enable(int size = GS_TRACE_DEFAULT_SIZE);
+    void Disable();
+    bool IsEnabled();
+    void Clear();
+    Record* BeginRecord();
+    void EndRecord(Record* pRecord, RecordType type, unsigned int tstates);
+    int GetCount();
+    const Record* GetRecord(int index);
+    u64 GetClock();
+    bool Save(const char* szFilePath);
+
+private:
+    Record* m_pRecords;
+    u32 m_iMask;
+    u32 m_iHead;
+    u32 m_iCount;
+    u64 m_iClock;
+};
+
+inline bool Tracer::IsEnabled()
+{
+    return IsValidPointer(m_pRecords);
+}
+
+inline Tracer::Record* Tracer::BeginRecord()
+{
+    Record* record = &m_pRecords[m_iHead];
+    m_iHead = (m_iHead + 1) & m_iMask;
+    m_iCount += (m_iCount <= m_iMask) ? 1 : 0;
+    return record;
+}
+
+inline void Tracer::EndRecord(Record* pRecord, RecordType type, unsigned int tstates)
+{
+    pRecord->type = static_cast<u8>(type);
+    pRecord->tstates = static_cast<u8>(tstates);
+    m_iClock += tstates;
+}
+
+#endif	/* TRACER_H */
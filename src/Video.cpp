@@ -20,15 +20,22 @@
 #include "Video.h"
 #include "Memory.h"
 #include "Processor.h"
+#include "Watchpoints.h"
 
 Video::Video(Memory* pMemory, Processor* pProcessor)
 {
     m_pMemory = pMemory;
     m_pProcessor = pProcessor;
     InitPointer(m_pInfoBuffer);
-    InitPointer(m_pColorFrameBuffer);
+    InitPointer(m_pFrameBuffer);
+    m_PixelFormat = Pixel_RGB888;
+    m_iFramePitch = 0;
+    m_iFrameHeight = GS_RESOLUTION_MAX_HEIGHT;
     InitPointer(m_pVdpVRAM);
     InitPointer(m_pVdpCRAM);
+    InitPointer(m_pWatchpoints);
+    InitPointer(m_pTimeline);
+    m_iTimelineFrame = 0;
     m_bFirstByteInSequence = false;
     for (int i = 0; i < 16; i++)
         m_VdpRegister[i] = 0;
@@ -60,16 +67,14 @@ Video::Video(Memory* pMemory, Processor* pProcessor)
 
 Video::~Video()
 {
-    SafeDeleteArray(m_pInfoBuffer);
-    SafeDeleteArray(m_pVdpVRAM);
-    SafeDeleteArray(m_pVdpCRAM);
+    SafeDeleteArray(m_pTimeline);
 }
 
-void Video::Init()
+void Video::Init(u8* pVRAM, u8* pCRAM, u8* pInfoBuffer)
 {
-    m_pInfoBuffer = new u8[GS_RESOLUTION_MAX_WIDTH * GS_LINES_PER_FRAME_PAL];
-    m_pVdpVRAM = new u8[0x4000];
-    m_pVdpCRAM = new u8[0x40];
+    m_pInfoBuffer = pInfoBuffer;
+    m_pVdpVRAM = pVRAM;
+    m_pVdpCRAM = pCRAM;
     Reset(false, false);
 }
 
@@ -157,6 +162,53 @@ void Video::SetSG1000Palette(GS_Color* pSG1000Palette)
     m_pSG1000Palette = pSG1000Palette;
 }
 
+void Video::SetWatchpoints(Watchpoints* pWatchpoints)
+{
+    m_pWatchpoints = pWatchpoints;
+}
+
+void Video::EnableTimeline(bool enable)
+{
+    if (enable == IsTimelineEnabled())
+        return;
+
+    if (enable)
+    {
+        // Two frames, one being recorded and the last complete one
+        m_pTimeline = new Timeline[2];
+        memset(m_pTimeline, 0, sizeof(Timeline) * 2);
+        m_iTimelineFrame = 0;
+    }
+    else
+    {
+        SafeDeleteArray(m_pTimeline);
+    }
+}
+
+bool Video::IsTimelineEnabled()
+{
+    return IsValidPointer(m_pTimeline);
+}
+
+const Video::Timeline* Video::GetTimeline()
+{
+    return IsValidPointer(m_pTimeline) ? &m_pTimeline[m_iTimelineFrame ^ 1] : NULL;
+}
+
+void Video::NextTimelineFrame()
+{
+    Timeline* timeline = &m_pTimeline[m_iTimelineFrame];
+    timeline->line_count = m_iLinesPerFrame;
+    timeline->active_lines = m_bExtendedMode224 ? 224 : 192;
+
+    m_iTimelineFrame ^= 1;
+
+    timeline = &m_pTimeline[m_iTimelineFrame];
+    memset(timeline->lines, 0, sizeof(timeline->lines));
+    timeline->event_count = 0;
+    timeline->dropped = 0;
+}
+
 u8* Video::GetVRAM()
 {
     return m_pVdpVRAM;
@@ -172,6 +224,22 @@ u8* Video::GetRegisters()
     return m_VdpRegister;
 }
 
+void Video::SetPixelFormat(GS_Pixel_Format format)
+{
+    m_PixelFormat = format;
+}
+
+GS_Pixel_Format Video::GetPixelFormat()
+{
+    return m_PixelFormat;
+}
+
+void Video::SetFrameBufferLayout(int pitch, int height)
+{
+    m_iFramePitch = pitch;
+    m_iFrameHeight = height;
+}
+
 GS_Color* Video::GetSG1000Palette()
 {
     return m_pSG1000Palette;
@@ -182,11 +250,11 @@ int Video::GetSG1000Mode()
     return m_iSG1000Mode;
 }
 
-bool Video::Tick(unsigned int clockCycles, GS_Color* pColorFrameBuffer)
+bool Video::Tick(unsigned int clockCycles, void* pFrameBuffer)
 {
     int max_height = m_bExtendedMode224 ? 224 : 192;
     bool return_vblank = false;
-    m_pColorFrameBuffer = pColorFrameBuffer;
+    m_pFrameBuffer = static_cast<u8*>(pFrameBuffer);
 
     m_iCycleCounter += clockCycles;
 
@@ -195,13 +263,23 @@ bool Video::Tick(unsigned int clockCycles, GS_Color* pColorFrameBuffer)
     {
         m_LineEvents.vint = true;
         if ((m_iRenderLine == (max_height + 1)) && (IsSetBit(m_VdpRegister[1], 5)))
-            m_pProcessor->RequestINT(true);
+        {
+            m_pProcessor->RequestINT(true, m_iCycleCounter - m_Timing[TIMING_VINT]);
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+            if (IsValidPointer(m_pTimeline))
+                AddTimelineEvent(TimelineVINT, 0, m_VdpStatus);
+#endif
+        }
     }
 
     ///// SCROLLX /////
     if (!m_LineEvents.scrollx && (m_iCycleCounter >= m_Timing[TIMING_XSCROLL]))
     {
         m_LineEvents.scrollx = true;
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+        if (IsValidPointer(m_pTimeline) && (m_ScrollX != m_VdpRegister[8]))
+            AddTimelineEvent(TimelineScrollX, 8, m_VdpRegister[8]);
+#endif
         m_ScrollX = m_VdpRegister[8];   // latch scroll X
     }
 
@@ -215,7 +293,13 @@ bool Video::Tick(unsigned int clockCycles, GS_Color* pColorFrameBuffer)
             {
                 m_iVdpRegister10Counter = m_VdpRegister[10];
                 if (!m_bSG1000 && IsSetBit(m_VdpRegister[0], 4))
-                    m_pProcessor->RequestINT(true);
+                {
+                    m_pProcessor->RequestINT(true, m_iCycleCounter - m_Timing[TIMING_HINT]);
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+                    if (IsValidPointer(m_pTimeline))
+                        AddTimelineEvent(TimelineHINT, 10, m_VdpRegister[10]);
+#endif
+                }
             }
             else
             {
@@ -234,6 +318,10 @@ bool Video::Tick(unsigned int clockCycles, GS_Color* pColorFrameBuffer)
         m_iVCounter++;
         if (m_iVCounter >= m_iLinesPerFrame)
         {
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+            if (IsValidPointer(m_pTimeline) && (m_ScrollY != m_VdpRegister[9]))
+                AddTimelineEvent(TimelineScrollY, 9, m_VdpRegister[9]);
+#endif
             m_ScrollY = m_VdpRegister[9];   // latch scroll Y
             m_iVCounter = 0;
         }
@@ -263,6 +351,10 @@ bool Video::Tick(unsigned int clockCycles, GS_Color* pColorFrameBuffer)
         }
         m_iRenderLine++;
         m_iRenderLine %= m_iLinesPerFrame;
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+        if (IsValidPointer(m_pTimeline) && (m_iRenderLine == 0))
+            NextTimelineFrame();
+#endif
         m_iCycleCounter -= GS_CYCLES_PER_LINE;
         m_LineEvents.hint = false;
         m_LineEvents.scrollx = false;
@@ -335,6 +427,12 @@ u8 Video::GetDataPort()
     m_bFirstByteInSequence = true;
     u8 ret = m_VdpBuffer;
     m_VdpBuffer = m_pVdpVRAM[m_VdpAddress];
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+    if (IsValidPointer(m_pWatchpoints) && m_pWatchpoints->IsWatched(Watchpoints::SpaceVRAM, m_VdpAddress, Watchpoints::AccessRead))
+        m_pWatchpoints->Check(Watchpoints::SpaceVRAM, m_VdpAddress, m_VdpBuffer, Watchpoints::AccessRead);
+    if (IsValidPointer(m_pTimeline))
+        GetTimelineLine()->vram_reads++;
+#endif
     m_VdpAddress++;
     m_VdpAddress &= 0x3FFF;
     return ret;
@@ -344,6 +442,10 @@ u8 Video::GetStatusFlags()
 {
     u8 ret = m_VdpStatus | (m_bSG1000 ? 0 : 0x1F);
     m_bFirstByteInSequence = true;
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+    if (IsValidPointer(m_pTimeline))
+        AddTimelineEvent(TimelineStatus, 0, ret);
+#endif
     m_VdpStatus = 0x00;
     m_pProcessor->RequestINT(false);
     return ret;
@@ -369,11 +471,21 @@ void Video::WriteData(u8 data)
         case VDP_WRITE_VRAM_OPERATION:
         case VDP_WRITE_REG_OPERATION:
         {
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+            if (IsValidPointer(m_pWatchpoints) && m_pWatchpoints->IsWatched(Watchpoints::SpaceVRAM, m_VdpAddress, Watchpoints::AccessWrite))
+                m_pWatchpoints->Check(Watchpoints::SpaceVRAM, m_VdpAddress, data, Watchpoints::AccessWrite);
+            if (IsValidPointer(m_pTimeline))
+                GetTimelineLine()->vram_writes++;
+#endif
             m_pVdpVRAM[m_VdpAddress] = data;
             break;
         }
         case VDP_WRITE_CRAM_OPERATION:
         {
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+            if (IsValidPointer(m_pTimeline))
+                GetTimelineLine()->cram_writes++;
+#endif
             m_pVdpCRAM[m_VdpAddress & (m_bGameGear ? 0x3F : 0x1F)] = data;
             break;
         }
@@ -397,7 +509,7 @@ void Video::WriteControl(u8 control)
 
         if (m_bSG1000 && (m_VdpCode == VDP_WRITE_CRAM_OPERATION))
         {
-            Log("--> ** SG-1000 Attempting to write on CRAM");
+            Log_Debug("--> ** SG-1000 Attempting to write on CRAM");
         }
 
         switch (m_VdpCode)
@@ -413,6 +525,10 @@ void Video::WriteControl(u8 control)
             {
                 u8 reg = control & (m_bSG1000 ? 0x07 : 0x0F);
                 m_VdpRegister[reg] = (m_VdpAddress & 0x00FF);
+#ifndef GEARSYSTEM_DISABLE_DISASSEMBLER
+                if (IsValidPointer(m_pTimeline))
+                    AddTimelineEvent(TimelineRegister, reg, m_VdpRegister[reg]);
+#endif
 
                 if (reg < 2)
                 {
@@ -423,7 +539,7 @@ void Video::WriteControl(u8 control)
                 }
                 else if (reg > 10)
                 {
-                    Log("--> ** Attempting to write on VDP REG %d: %X", reg, control);
+                    Log_Debug("--> ** Attempting to write on VDP REG %d: %X", reg, control);
                 }
                 break;
             }
@@ -465,14 +581,18 @@ void Video::ScanLine(int line)
         if (line < max_height)
         {
             int line_width = line * m_iScreenWidth;
+            u8* frame_line = GetFrameLine(line);
 
             for (int scx = 0; scx < m_iScreenWidth; scx++)
             {
                 int pixel = line_width + scx;
 
-                GS_Color final_color = {0,0,0};
+                if (IsValidPointer(frame_line))
+                {
+                    GS_Color final_color = {0,0,0};
+                    WritePixel(frame_line, scx, final_color);
+                }
 
-                m_pColorFrameBuffer[pixel] = final_color;
                 m_pInfoBuffer[pixel] = 0;
             }
         }
@@ -489,6 +609,14 @@ void Video::RenderBackgroundSMSGG(int line)
     int scy_adjust = m_bGameGear ? y_offset : 0;
     int scy = line;
     int line_width = (line - scy_adjust) * m_iScreenWidth;
+
+    if (!IsValidPointer(m_pFrameBuffer))
+    {
+        // Render skip, only the sprite bits need to be cleared
+        memset(m_pInfoBuffer + line_width, 0, m_iScreenWidth);
+        return;
+    }
+
     int origin_x = m_ScrollX;
     if ((line < 16) && IsSetBit(m_VdpRegister[0], 6))
         origin_x = 0;
@@ -514,12 +642,13 @@ void Video::RenderBackgroundSMSGG(int line)
     int scx_end = scx_begin + m_iScreenWidth;
 
     int max_height = m_bExtendedMode224 ? 224 : 192;
+    u8* frame_line = GetFrameLine(line - scy_adjust);
 
     for (int scx = scx_begin; scx < scx_end; scx++)
     {
         int pixel = line_width + scx - scx_begin;
 
-        if (line < max_height)
+        if ((line < max_height) && IsValidPointer(frame_line))
         {
             if (IsSetBit(m_VdpRegister[0], 5) && scx < 8)
             {
@@ -571,7 +700,7 @@ void Video::RenderBackgroundSMSGG(int line)
                 }
             }
 
-            m_pColorFrameBuffer[pixel] = ConvertTo8BitColor(palette_color);
+            WritePixel(frame_line, scx - scx_begin, ConvertTo8BitColor(palette_color));
         }
 
         m_pInfoBuffer[pixel] = 0;
@@ -644,6 +773,7 @@ void Video::RenderSpritesSMSGG(int line)
 
     int scx_begin = m_bGameGear ? GS_RESOLUTION_GG_X_OFFSET : 0;
     int scx_end = scx_begin + m_iScreenWidth;
+    u8* frame_line = (line < max_height) ? GetFrameLine(line - scy_adjust) : NULL;
 
     for (int i = 7; i >= 0; i--)
     {
@@ -683,8 +813,8 @@ void Video::RenderSpritesSMSGG(int line)
 
             palette_color += 16;
 
-            if (line < max_height)
-                m_pColorFrameBuffer[pixel] = ConvertTo8BitColor(palette_color);
+            if (IsValidPointer(frame_line))
+                WritePixel(frame_line, sprite_pixel_x - scx_begin, ConvertTo8BitColor(palette_color));
 
             if ((m_pInfoBuffer[pixel] & 0x01) != 0)
                 sprite_collision = true;
@@ -701,6 +831,12 @@ void Video::RenderBackgroundSG1000(int line)
 {
     int line_width = line * m_iScreenWidth;
 
+    if (!IsValidPointer(m_pFrameBuffer))
+    {
+        memset(m_pInfoBuffer + line_width, 0, m_iScreenWidth);
+        return;
+    }
+
     int name_table_addr = (m_VdpRegister[2] & 0x0F) << 10;
     int pattern_table_addr = 0;
     int color_table_addr = 0;
@@ -718,6 +854,7 @@ void Video::RenderBackgroundSG1000(int line)
 
     int region = (m_VdpRegister[4] & 0x03) << 8;
     int backdrop_color = m_VdpRegister[7] & 0x0F;
+    u8* frame_line = GetFrameLine(line);
 
     int tile_y = line >> 3;
     int tile_y_offset = line & 7;
@@ -754,7 +891,8 @@ void Video::RenderBackgroundSG1000(int line)
 
         int final_color = IsSetBit(pattern_line, 7 - tile_x_offset) ? fg_color : bg_color;
 
-        m_pColorFrameBuffer[pixel] = m_pSG1000Palette[(final_color > 0) ? final_color : backdrop_color];
+        if (IsValidPointer(frame_line))
+            WritePixel(frame_line, scx, m_pSG1000Palette[(final_color > 0) ? final_color : backdrop_color]);
         m_pInfoBuffer[pixel] = 0x00;
     }
 }
@@ -764,6 +902,7 @@ void Video::RenderSpritesSG1000(int line)
     int sprite_collision = false;
     int sprite_count = 0;
     int line_width = line * m_iScreenWidth;
+    u8* frame_line = GetFrameLine(line);
     int sprite_size = IsSetBit(m_VdpRegister[1], 1) ? 16 : 8;
     bool sprite_zoom = IsSetBit(m_VdpRegister[1], 0);
     if (sprite_zoom)
@@ -837,7 +976,8 @@ void Video::RenderSpritesSG1000(int line)
 
             if (sprite_pixel && (sprite_count < 5) && ((m_pInfoBuffer[pixel] & 0x08) == 0))
             {
-                m_pColorFrameBuffer[pixel] = m_pSG1000Palette[sprite_color];
+                if (IsValidPointer(frame_line))
+                    WritePixel(frame_line, sprite_pixel_x, m_pSG1000Palette[sprite_color]);
                 m_pInfoBuffer[pixel] |= 0x08;
             }
 
@@ -921,3 +1061,30 @@ void Video::LoadState(std::istream& stream)
     stream.read(reinterpret_cast<char*> (&m_Timing), sizeof(m_Timing));
     stream.read(reinterpret_cast<char*> (&m_NextLineSprites), sizeof(m_NextLineSprites));
 }
+
+void Video::CopyState(const Video* pSource)
+{
+    memcpy(m_VdpRegister, pSource->m_VdpRegister, sizeof(m_VdpRegister));
+    m_bFirstByteInSequence = pSource->m_bFirstByteInSequence;
+    m_VdpCode = pSource->m_VdpCode;
+    m_VdpBuffer = pSource->m_VdpBuffer;
+    m_VdpAddress = pSource->m_VdpAddress;
+    m_iVCounter = pSource->m_iVCounter;
+    m_iHCounter = pSource->m_iHCounter;
+    m_iCycleCounter = pSource->m_iCycleCounter;
+    m_VdpStatus = pSource->m_VdpStatus;
+    m_iVdpRegister10Counter = pSource->m_iVdpRegister10Counter;
+    m_ScrollX = pSource->m_ScrollX;
+    m_ScrollY = pSource->m_ScrollY;
+    m_iLinesPerFrame = pSource->m_iLinesPerFrame;
+    m_bExtendedMode224 = pSource->m_bExtendedMode224;
+    m_LineEvents = pSource->m_LineEvents;
+    m_iRenderLine = pSource->m_iRenderLine;
+    m_bGameGear = pSource->m_bGameGear;
+    m_bPAL = pSource->m_bPAL;
+    m_iScreenWidth = pSource->m_iScreenWidth;
+    m_bSG1000 = pSource->m_bSG1000;
+    m_iSG1000Mode = pSource->m_iSG1000Mode;
+    memcpy(m_Timing, pSource->m_Timing, sizeof(m_Timing));
+    memcpy(m_NextLineSprites, pSource->m_NextLineSprites, sizeof(m_NextLineSprites));
+}
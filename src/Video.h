@@ -20,6 +20,7 @@
 #ifndef VIDEO_H
 #define	VIDEO_H
 
+#include <algorithm>
 #include "definitions.h"
 
 #define VDP_READ_VRAM_OPERATION 0x00
@@ -27,17 +28,58 @@
 #define VDP_WRITE_REG_OPERATION 0x02
 #define VDP_WRITE_CRAM_OPERATION 0x03
 
+#define GS_VDP_TIMELINE_EVENTS 4096
+
 class Memory;
 class Processor;
+class Watchpoints;
 
 class Video
 {
+public:
+    enum TimelineEventType
+    {
+        TimelineRegister,
+        TimelineHINT,
+        TimelineVINT,
+        TimelineStatus,
+        TimelineScrollX,
+        TimelineScrollY
+    };
+
+    struct TimelineEvent
+    {
+        u16 line;
+        u8 cycle;
+        u8 type;
+        u8 index;
+        u8 value;
+    };
+
+    struct TimelineLine
+    {
+        u16 vram_writes;
+        u16 vram_reads;
+        u16 cram_writes;
+    };
+
+    // One frame of VDP activity, from line 0 to the last line
+    struct Timeline
+    {
+        TimelineLine lines[GS_LINES_PER_FRAME_PAL];
+        TimelineEvent events[GS_VDP_TIMELINE_EVENTS];
+        int event_count;
+        int dropped;
+        int line_count;
+        int active_lines;
+    };
+
 public:
     Video(Memory* pMemory, Processor* pProcessor);
     ~Video();
-    void Init();
+    void Init(u8* pVRAM, u8* pCRAM, u8* pInfoBuffer);
     void Reset(bool bGameGear, bool bPAL);
-    bool Tick(unsigned int clockCycles, GS_Color* pColorFrameBuffer);
+    bool Tick(unsigned int clockCycles, void* pFrameBuffer);
     u8 GetVCounter();
     u8 GetHCounter();
     u8 GetDataPort();
@@ -49,13 +91,21 @@ public:
     void LatchHCounter();
     void SaveState(std::ostream& stream);
     void LoadState(std::istream& stream);
+    void CopyState(const Video* pSource);
     void SetSG1000Palette(GS_Color* pSG1000Palette);
+    void SetWatchpoints(Watchpoints* pWatchpoints);
+    void EnableTimeline(bool enable);
+    bool IsTimelineEnabled();
+    const Timeline* GetTimeline();
     u8* GetVRAM();
     u8* GetCRAM();
     u8* GetRegisters();
     GS_Color* GetSG1000Palette();
     int GetSG1000Mode();
     GS_Color ConvertTo8BitColor(int palette_color);
+    void SetPixelFormat(GS_Pixel_Format format);
+    GS_Pixel_Format GetPixelFormat();
+    void SetFrameBufferLayout(int pitch, int height);
 
 private:
     void ScanLine(int line);
@@ -64,14 +114,25 @@ private:
     void ParseSpritesSMSGG(int line);
     void RenderSpritesSMSGG(int line);
     void RenderSpritesSG1000(int line);
+    u8* GetFrameLine(int row);
+    void WritePixel(u8* pFrameLine, int x, GS_Color color);
+    void AddTimelineEvent(TimelineEventType type, u8 index, u8 value);
+    TimelineLine* GetTimelineLine();
+    void NextTimelineFrame();
 
 private:
     Memory* m_pMemory;
     Processor* m_pProcessor;
     u8* m_pInfoBuffer;
-    GS_Color* m_pColorFrameBuffer;
+    u8* m_pFrameBuffer;
+    GS_Pixel_Format m_PixelFormat;
+    int m_iFramePitch;
+    int m_iFrameHeight;
     u8* m_pVdpVRAM;
     u8* m_pVdpCRAM;
+    Watchpoints* m_pWatchpoints;
+    Timeline* m_pTimeline;
+    int m_iTimelineFrame;
     bool m_bFirstByteInSequence;
     u8 m_VdpRegister[16];
     u8 m_VdpCode;
@@ -156,6 +217,77 @@ inline GS_Color Video::ConvertTo8BitColor(int palette_color)
     return final_color;
 }
 
+// A pitch of 0 packs the rows at the screen width, rows past the height are
+// clipped so frontends can hand over buffers sized to the visible screen
+inline u8* Video::GetFrameLine(int row)
+{
+    if (!IsValidPointer(m_pFrameBuffer) || (row >= m_iFrameHeight))
+        return NULL;
+
+    int pitch = m_iFramePitch;
+
+    if (pitch == 0)
+    {
+        switch (m_PixelFormat)
+        {
+            case Pixel_Gray8:
+                pitch = m_iScreenWidth;
+                break;
+            case Pixel_XRGB8888:
+                pitch = m_iScreenWidth * 4;
+                break;
+            case Pixel_RGB565:
+                pitch = m_iScreenWidth * 2;
+                break;
+            default:
+                pitch = m_iScreenWidth * 3;
+        }
+    }
+
+    return m_pFrameBuffer + (row * pitch);
+}
+
+inline void Video::WritePixel(u8* pFrameLine, int x, GS_Color color)
+{
+    switch (m_PixelFormat)
+    {
+        case Pixel_Gray8:
+            pFrameLine[x] = static_cast<u8>(((color.red * 77) + (color.green * 150) + (color.blue * 29)) >> 8);
+            break;
+        case Pixel_XRGB8888:
+            reinterpret_cast<u32*>(pFrameLine)[x] = (color.red << 16) | (color.green << 8) | color.blue;
+            break;
+        case Pixel_RGB565:
+            reinterpret_cast<u16*>(pFrameLine)[x] = static_cast<u16>(((color.red >> 3) << 11) | ((color.green >> 2) << 5) | (color.blue >> 3));
+            break;
+        default:
+            reinterpret_cast<GS_Color*>(pFrameLine)[x] = color;
+    }
+}
+
+inline void Video::AddTimelineEvent(TimelineEventType type, u8 index, u8 value)
+{
+    Timeline* timeline = &m_pTimeline[m_iTimelineFrame];
+
+    if (timeline->event_count >= GS_VDP_TIMELINE_EVENTS)
+    {
+        timeline->dropped++;
+        return;
+    }
+
+    TimelineEvent* event = &timeline->events[timeline->event_count++];
+    event->line = static_cast<u16>(m_iRenderLine);
+    event->cycle = static_cast<u8>(std::min(m_iCycleCounter, GS_CYCLES_PER_LINE - 1));
+    event->type = static_cast<u8>(type);
+    event->index = index;
+    event->value = value;
+}
+
+inline Video::TimelineLine* Video::GetTimelineLine()
+{
+    return &m_pTimeline[m_iTimelineFrame].lines[m_iRenderLine];
+}
+
 const u8 kVdpHCounter[228] = {
 
   0xE9,0xEA,0xEA,0xEB,0xEC,0xED,0xED,0xEE,0xEF,0xF0,0xF0,0xF1,0xF2,0xF3,0xF3,0xF4,
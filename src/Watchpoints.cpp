@@ -0,0 +1,566 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <ctype.h>
+#include <algorithm>
+#include "Watchpoints.h"
+#include "Memory.h"
+#include "Processor.h"
+
+enum Watch_OPCode
+{
+    Watch_Const,
+    Watch_Register,
+    Watch_Value,
+    Watch_Address,
+    Watch_Memory,
+    Watch_Not,
+    Watch_Negate,
+    Watch_Complement,
+    Watch_Add,
+    Watch_Sub,
+    Watch_And,
+    Watch_Or,
+    Watch_Xor,
+    Watch_Equal,
+    Watch_NotEqual,
+    Watch_Less,
+    Watch_LessEqual,
+    Watch_Greater,
+    Watch_GreaterEqual,
+    Watch_LogicalAnd,
+    Watch_LogicalOr
+};
+
+enum Watch_Register
+{
+    Watch_A, Watch_F, Watch_B, Watch_C, Watch_D, Watch_E, Watch_H, Watch_L,
+    Watch_I, Watch_R, Watch_AF, Watch_BC, Watch_DE, Watch_HL, Watch_IX,
+    Watch_IY, Watch_SP, Watch_PC
+};
+
+struct Watch_Name
+{
+    const char* name;
+    int id;
+};
+
+static const Watch_Name kWatchRegisters[] =
+{
+    { "A", Watch_A }, { "F", Watch_F }, { "B", Watch_B }, { "C", Watch_C },
+    { "D", Watch_D }, { "E", Watch_E }, { "H", Watch_H }, { "L", Watch_L },
+    { "I", Watch_I }, { "R", Watch_R }, { "AF", Watch_AF }, { "BC", Watch_BC },
+    { "DE", Watch_DE }, { "HL", Watch_HL }, { "IX", Watch_IX }, { "IY", Watch_IY },
+    { "SP", Watch_SP }, { "PC", Watch_PC }
+};
+
+struct Watch_Operator
+{
+    const char* token;
+    int precedence;
+    Watch_OPCode op;
+};
+
+// Longer tokens go first so "<=" is not taken as "<"
+static const Watch_Operator kWatchOperators[] =
+{
+    { "||", 1, Watch_LogicalOr },
+    { "&&", 2, Watch_LogicalAnd },
+    { "==", 6, Watch_Equal },
+    { "!=", 6, Watch_NotEqual },
+    { "<=", 7, Watch_LessEqual },
+    { ">=", 7, Watch_GreaterEqual },
+    { "<", 7, Watch_Less },
+    { ">", 7, Watch_Greater },
+    { "|", 3, Watch_Or },
+    { "^", 4, Watch_Xor },
+    { "&", 5, Watch_And },
+    { "+", 8, Watch_Add },
+    { "-", 8, Watch_Sub }
+};
+
+class Watch_Compiler
+{
+public:
+    Watch_Compiler(const char* szText, std::vector<Watchpoints::Instruction>& program)
+        : m_szText(szText), m_Program(program), m_iDepth(0), m_iMaxDepth(0) { }
+
+    bool Compile(std::string& error)
+    {
+        m_Program.clear();
+
+        if (!ParseExpression(1) || !Expect(0))
+        {
+            error = m_Error;
+            return false;
+        }
+
+        if (m_iMaxDepth > GS_WATCH_STACK_SIZE)
+        {
+            error = "Condition is too complex";
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    bool ParseExpression(int min_precedence)
+    {
+        if (!ParseUnary())
+            return false;
+
+        while (true)
+        {
+            const Watch_Operator* op = PeekOperator();
+
+            if (!IsValidPointer(op) || (op->precedence < min_precedence))
+                return true;
+
+            m_szText += strlen(op->token);
+
+            if (!ParseExpression(op->precedence + 1))
+                return false;
+
+            Emit(op->op, 0, -1);
+        }
+    }
+
+    bool ParseUnary()
+    {
+        SkipSpaces();
+
+        char c = *m_szText;
+
+        if ((c == '!') || (c == '-') || (c == '~'))
+        {
+            m_szText++;
+
+            if (!ParseUnary())
+                return false;
+
+            Emit((c == '!') ? Watch_Not : ((c == '-') ? Watch_Negate : Watch_Complement), 0, 0);
+            return true;
+        }
+
+        return ParsePrimary();
+    }
+
+    bool ParsePrimary()
+    {
+        SkipSpaces();
+
+        char c = *m_szText;
+
+        if ((c == '(') || (c == '['))
+        {
+            m_szText++;
+
+            if (!ParseExpression(1) || !Expect((c == '(') ? ')' : ']'))
+                return false;
+
+            if (c == '[')
+                Emit(Watch_Memory, 0, 0);
+
+            return true;
+        }
+
+        if (c == '$')
+        {
+            m_szText++;
+            return ParseNumber();
+        }
+
+        if (!isalnum(static_cast<unsigned char>(c)))
+            return Fail("Expected a value");
+
+        const char* start = m_szText;
+
+        while (isalnum(static_cast<unsigned char>(*m_szText)))
+            m_szText++;
+
+        std::string word(start, m_szText - start);
+
+        for (size_t i = 0; i < word.size(); i++)
+            word[i] = static_cast<char>(toupper(static_cast<unsigned char>(word[i])));
+
+        for (size_t i = 0; i < sizeof(kWatchRegisters) / sizeof(kWatchRegisters[0]); i++)
+        {
+            if (word == kWatchRegisters[i].name)
+            {
+                Emit(Watch_Register, static_cast<u16>(kWatchRegisters[i].id), 1);
+                return true;
+            }
+        }
+
+        if (word == "VALUE")
+        {
+            Emit(Watch_Value, 0, 1);
+            return true;
+        }
+
+        if (word == "ADDR")
+        {
+            Emit(Watch_Address, 0, 1);
+            return true;
+        }
+
+        m_szText = start;
+
+        if ((word.size() > 2) && (word[0] == '0') && (word[1] == 'X'))
+            m_szText += 2;
+
+        return ParseNumber();
+    }
+
+    bool ParseNumber()
+    {
+        if (!isxdigit(static_cast<unsigned char>(*m_szText)))
+            return Fail("Expected a number");
+
+        u32 value = 0;
+
+        while (isxdigit(static_cast<unsigned char>(*m_szText)))
+        {
+            char c = static_cast<char>(toupper(static_cast<unsigned char>(*m_szText)));
+            value = (value << 4) | static_cast<u32>((c <= '9') ? (c - '0') : (c - 'A' + 10));
+            m_szText++;
+
+            if (value > 0xFFFF)
+                return Fail("Number out of range");
+        }
+
+        if (isalnum(static_cast<unsigned char>(*m_szText)))
+            return Fail("Unknown name");
+
+        Emit(Watch_Const, static_cast<u16>(value), 1);
+        return true;
+    }
+
+    const Watch_Operator* PeekOperator()
+    {
+        SkipSpaces();
+
+        for (size_t i = 0; i < sizeof(kWatchOperators) / sizeof(kWatchOperators[0]); i++)
+        {
+            const char* token = kWatchOperators[i].token;
+
+            if (strncmp(m_szText, token, strlen(token)) == 0)
+                return &kWatchOperators[i];
+        }
+
+        return NULL;
+    }
+
+    bool Expect(char c)
+    {
+        SkipSpaces();
+
+        if (*m_szText != c)
+            return Fail((c == 0) ? "Unexpected characters at the end" : "Unbalanced brackets");
+
+        if (c != 0)
+            m_szText++;
+
+        return true;
+    }
+
+    void Emit(Watch_OPCode op, u16 operand, int depth)
+    {
+        Watchpoints::Instruction instruction;
+        instruction.op = static_cast<u8>(op);
+        instruction.operand = operand;
+        m_Program.push_back(instruction);
+
+        m_iDepth += depth;
+        m_iMaxDepth = std::max(m_iMaxDepth, m_iDepth);
+    }
+
+    bool Fail(const char* szError)
+    {
+        if (m_Error.empty())
+            m_Error = szError;
+        return false;
+    }
+
+    void SkipSpaces()
+    {
+        while (isspace(static_cast<unsigned char>(*m_szText)))
+            m_szText++;
+    }
+
+private:
+    const char* m_szText;
+    std::vector<Watchpoints::Instruction>& m_Program;
+    std::string m_Error;
+    int m_iDepth;
+    int m_iMaxDepth;
+};
+
+Watchpoints::Watchpoints(Memory* pMemory, Processor* pProcessor)
+{
+    m_pMemory = pMemory;
+    m_pProcessor = pProcessor;
+    m_bHit = false;
+    m_bLastHitValid = false;
+    UpdatePages();
+}
+
+Watchpoints::~Watchpoints()
+{
+}
+
+bool Watchpoints::Compile(const char* szCondition, std::vector<Instruction>& program, std::string* pError)
+{
+    program.clear();
+
+    if (!IsValidPointer(szCondition))
+        return true;
+
+    const char* text = szCondition;
+
+    while (isspace(static_cast<unsigned char>(*text)))
+        text++;
+
+    // An empty condition always triggers
+    if (*text == 0)
+        return true;
+
+    std::string error;
+    Watch_Compiler compiler(text, program);
+
+    if (compiler.Compile(error))
+        return true;
+
+    program.clear();
+
+    if (IsValidPointer(pError))
+        *pError = error;
+
+    return false;
+}
+
+bool Watchpoints::Add(Space space, u16 start, u16 end, u8 access, const char* szCondition, std::string* pError)
+{
+    Watchpoint watchpoint;
+    watchpoint.space = space;
+    watchpoint.start = std::min(start, end);
+    watchpoint.end = std::max(start, end);
+    watchpoint.access = access & (AccessRead | AccessWrite);
+    watchpoint.enabled = true;
+    watchpoint.hits = 0;
+    watchpoint.condition = IsValidPointer(szCondition) ? szCondition : "";
+
+    if (watchpoint.access == 0)
+    {
+        if (IsValidPointer(pError))
+            *pError = "No access type selected";
+        return false;
+    }
+
+    if (!Compile(szCondition, watchpoint.program, pError))
+        return false;
+
+    m_Watchpoints.push_back(watchpoint);
+    UpdatePages();
+
+    return true;
+}
+
+void Watchpoints::Remove(int index)
+{
+    if ((index < 0) || (index >= GetCount()))
+        return;
+
+    m_Watchpoints.erase(m_Watchpoints.begin() + index);
+    m_bLastHitValid = false;
+    UpdatePages();
+}
+
+void Watchpoints::SetEnabled(int index, bool enabled)
+{
+    if ((index < 0) || (index >= GetCount()))
+        return;
+
+    m_Watchpoints[index].enabled = enabled;
+    UpdatePages();
+}
+
+void Watchpoints::Clear()
+{
+    m_Watchpoints.clear();
+    m_bHit = false;
+    m_bLastHitValid = false;
+    UpdatePages();
+}
+
+int Watchpoints::GetCount()
+{
+    return static_cast<int>(m_Watchpoints.size());
+}
+
+const Watchpoints::Watchpoint* Watchpoints::Get(int index)
+{
+    return &m_Watchpoints[index];
+}
+
+const Watchpoints::Hit* Watchpoints::GetLastHit()
+{
+    return m_bLastHitValid ? &m_LastHit : NULL;
+}
+
+void Watchpoints::Check(Space space, u16 address, u8 value, u8 access)
+{
+    for (size_t i = 0; i < m_Watchpoints.size(); i++)
+    {
+        Watchpoint& watchpoint = m_Watchpoints[i];
+
+        if (!watchpoint.enabled || (watchpoint.space != space) || !(watchpoint.access & access))
+            continue;
+
+        if ((address < watchpoint.start) || (address > watchpoint.end))
+            continue;
+
+        if (!watchpoint.program.empty() && (Evaluate(watchpoint.program, address, value) == 0))
+            continue;
+
+        watchpoint.hits++;
+
+        if (!m_bHit)
+        {
+            m_bHit = true;
+            m_bLastHitValid = true;
+            m_LastHit.index = static_cast<int>(i);
+            m_LastHit.space = space;
+            m_LastHit.access = access;
+            m_LastHit.address = address;
+            m_LastHit.value = value;
+        }
+    }
+}
+
+int Watchpoints::Evaluate(const std::vector<Instruction>& program, u16 address, u8 value)
+{
+    int stack[GS_WATCH_STACK_SIZE];
+    int top = -1;
+    Processor::ProcessorState* state = m_pProcessor->GetState();
+
+    for (size_t i = 0; i < program.size(); i++)
+    {
+        const Instruction& instruction = program[i];
+
+        switch (instruction.op)
+        {
+            case Watch_Const:
+                stack[++top] = instruction.operand;
+                break;
+            case Watch_Register:
+            {
+                int reg = 0;
+                switch (instruction.operand)
+                {
+                    case Watch_A: reg = state->AF->GetHigh(); break;
+                    case Watch_F: reg = state->AF->GetLow(); break;
+                    case Watch_B: reg = state->BC->GetHigh(); break;
+                    case Watch_C: reg = state->BC->GetLow(); break;
+                    case Watch_D: reg = state->DE->GetHigh(); break;
+                    case Watch_E: reg = state->DE->GetLow(); break;
+                    case Watch_H: reg = state->HL->GetHigh(); break;
+                    case Watch_L: reg = state->HL->GetLow(); break;
+                    case Watch_I: reg = state->I->GetValue(); break;
+                    case Watch_R: reg = state->R->GetValue(); break;
+                    case Watch_AF: reg = state->AF->GetValue(); break;
+                    case Watch_BC: reg = state->BC->GetValue(); break;
+                    case Watch_DE: reg = state->DE->GetValue(); break;
+                    case Watch_HL: reg = state->HL->GetValue(); break;
+                    case Watch_IX: reg = state->IX->GetValue(); break;
+                    case Watch_IY: reg = state->IY->GetValue(); break;
+                    case Watch_SP: reg = state->SP->GetValue(); break;
+                    case Watch_PC: reg = state->PC->GetValue(); break;
+                }
+                stack[++top] = reg;
+                break;
+            }
+            case Watch_Value:
+                stack[++top] = value;
+                break;
+            case Watch_Address:
+                stack[++top] = address;
+                break;
+            case Watch_Memory:
+                // Goes to the mapper directly so it does not trigger watchpoints
+                stack[top] = m_pMemory->Peek(static_cast<u16>(stack[top]));
+                break;
+            case Watch_Not:
+                stack[top] = !stack[top];
+                break;
+            case Watch_Negate:
+                stack[top] = -stack[top];
+                break;
+            case Watch_Complement:
+                stack[top] = ~stack[top];
+                break;
+            default:
+            {
+                int b = stack[top--];
+                int a = stack[top];
+                int result = 0;
+                switch (instruction.op)
+                {
+                    case Watch_Add: result = a + b; break;
+                    case Watch_Sub: result = a - b; break;
+                    case Watch_And: result = a & b; break;
+                    case Watch_Or: result = a | b; break;
+                    case Watch_Xor: result = a ^ b; break;
+                    case Watch_Equal: result = (a == b); break;
+                    case Watch_NotEqual: result = (a != b); break;
+                    case Watch_Less: result = (a < b); break;
+                    case Watch_LessEqual: result = (a <= b); break;
+                    case Watch_Greater: result = (a > b); break;
+                    case Watch_GreaterEqual: result = (a >= b); break;
+                    case Watch_LogicalAnd: result = (a && b); break;
+                    case Watch_LogicalOr: result = (a || b); break;
+                }
+                stack[top] = result;
+                break;
+            }
+        }
+    }
+
+    return stack[top];
+}
+
+void Watchpoints::UpdatePages()
+{
+    memset(m_Pages, 0, sizeof(m_Pages));
+
+    for (size_t i = 0; i < m_Watchpoints.size(); i++)
+    {
+        const Watchpoint& watchpoint = m_Watchpoints[i];
+
+        if (!watchpoint.enabled)
+            continue;
+
+        int shift = (watchpoint.space == SpaceIO) ? 0 : 8;
+        int last = std::min(watchpoint.end >> shift, 0xFF);
+
+        for (int page = (watchpoint.start >> shift); page <= last; page++)
+            m_Pages[watchpoint.space][page] |= watchpoint.access;
+    }
+}
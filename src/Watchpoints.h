@@ -0,0 +1,123 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef WATCHPOINTS_H
+#define	WATCHPOINTS_H
+
+#include <string>
+#include <vector>
+#include "definitions.h"
+
+#define GS_WATCH_STACK_SIZE 16
+
+class Memory;
+class Processor;
+
+class Watchpoints
+{
+public:
+    enum Space
+    {
+        SpaceCPU,
+        SpaceVRAM,
+        SpaceIO,
+        SpaceCount
+    };
+
+    enum Access
+    {
+        AccessRead = 0x01,
+        AccessWrite = 0x02
+    };
+
+    struct Instruction
+    {
+        u8 op;
+        u16 operand;
+    };
+
+    struct Watchpoint
+    {
+        Space space;
+        u16 start;
+        u16 end;
+        u8 access;
+        bool enabled;
+        u32 hits;
+        std::string condition;
+        std::vector<Instruction> program;
+    };
+
+    struct Hit
+    {
+        int index;
+        Space space;
+        u8 access;
+        u16 address;
+        u8 value;
+    };
+
+public:
+    Watchpoints(Memory* pMemory, Processor* pProcessor);
+    ~Watchpoints();
+    bool Add(Space space, u16 start, u16 end, u8 access, const char* szCondition, std::string* pError = NULL);
+    void Remove(int index);
+    void SetEnabled(int index, bool enabled);
+    void Clear();
+    int GetCount();
+    const Watchpoint* Get(int index);
+    const Hit* GetLastHit();
+    bool IsWatched(Space space, u16 address, u8 access);
+    void Check(Space space, u16 address, u8 value, u8 access);
+    bool ConsumeHit();
+
+    // Conditions use C operators on registers (A, BC, IX, PC...), VALUE and
+    // ADDR of the access, [expr] for CPU memory and hex numbers. Names of
+    // registers win over hex, $BC is a number
+    static bool Compile(const char* szCondition, std::vector<Instruction>& program, std::string* pError);
+
+private:
+    int Evaluate(const std::vector<Instruction>& program, u16 address, u8 value);
+    void UpdatePages();
+
+private:
+    Memory* m_pMemory;
+    Processor* m_pProcessor;
+    std::vector<Watchpoint> m_Watchpoints;
+    u8 m_Pages[SpaceCount][256];
+    Hit m_LastHit;
+    bool m_bHit;
+    bool m_bLastHitValid;
+};
+
+inline bool Watchpoints::IsWatched(Space space, u16 address, u8 access)
+{
+    // CPU and VRAM are watched in 256 byte pages, ports one by one
+    int page = (space == SpaceIO) ? (address & 0xFF) : (address >> 8);
+    return (m_Pages[space][page] & access) != 0;
+}
+
+inline bool Watchpoints::ConsumeHit()
+{
+    bool hit = m_bHit;
+    m_bHit = false;
+    return hit;
+}
+
+#endif	/* WATCHPOINTS_H */
@@ -453,6 +453,28 @@ void Blip_Buffer::save_state( blip_buffer_state_t* out )
 	memcpy( out->buf, &buffer_ [offset_ >> BLIP_BUFFER_ACCURACY], sizeof out->buf );
 }
 
+void Blip_Buffer::copy_state( Blip_Buffer const& in, blip_time_t in_time, blip_time_t own_time )
+{
+	assert( buffer_size_ == in.buffer_size_ && factor_ == in.factor_ );
+	
+	long const max_count = buffer_size_ + blip_buffer_extra_;
+	long count = (long) (in.resampled_time( in_time ) >> BLIP_BUFFER_ACCURACY) + blip_buffer_extra_;
+	long own_count = (long) (resampled_time( own_time ) >> BLIP_BUFFER_ACCURACY) + blip_buffer_extra_;
+	if ( count > max_count )
+		count = max_count;
+	if ( own_count > max_count )
+		own_count = max_count;
+	
+	// past the written deltas the buffer is always zero
+	memcpy( buffer_, in.buffer_, count * sizeof *buffer_ );
+	if ( own_count > count )
+		memset( buffer_ + count, 0, (own_count - count) * sizeof *buffer_ );
+	
+	offset_       = in.offset_;
+	reader_accum_ = in.reader_accum_;
+	modified_     = in.modified_ ? this : 0;
+}
+
 void Blip_Buffer::load_state( blip_buffer_state_t const& in )
 {
 	clear( false );
@@ -80,6 +80,11 @@ public:
 	// settings during same run of program. States can NOT be stored on disk.
 	// Clears buffer before loading state.
 	void load_state( blip_buffer_state_t const& in );
+	
+	// Copies samples and deltas from a buffer with the same rates, unlike
+	// save_state() it works in the middle of a frame. Times are how far each
+	// buffer has been written in its current frame.
+	void copy_state( Blip_Buffer const& in, blip_time_t in_time, blip_time_t own_time );
 
 	// Number of samples delay from synthesis to samples read out
 	int output_latency() const;
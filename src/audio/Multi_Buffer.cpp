@@ -83,6 +83,12 @@ void Tracked_Blip_Buffer::end_frame( blip_time_t t )
 		last_non_silence = (int)samples_avail() + blip_buffer_extra_;
 }
 
+void Tracked_Blip_Buffer::copy_state( Tracked_Blip_Buffer const& in, blip_time_t in_time, blip_time_t own_time )
+{
+	Blip_Buffer::copy_state( in, in_time, own_time );
+	last_non_silence = in.last_non_silence;
+}
+
 blip_ulong Tracked_Blip_Buffer::non_silent() const
 {
 	return last_non_silence | unsettled();
@@ -163,6 +169,13 @@ void Stereo_Buffer::clear()
 		bufs [i].clear();
 }
 
+void Stereo_Buffer::copy_state( Stereo_Buffer const& in, blip_time_t in_time, blip_time_t own_time )
+{
+	mixer.samples_read = in.mixer.samples_read;
+	for ( int i = bufs_size; --i >= 0; )
+		bufs [i].copy_state( in.bufs [i], in_time, own_time );
+}
+
 void Stereo_Buffer::end_frame( blip_time_t time )
 {
 	for ( int i = bufs_size; --i >= 0; )
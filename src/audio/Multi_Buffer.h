@@ -113,6 +113,7 @@ public:
 		Tracked_Blip_Buffer();
 		void clear();
 		void end_frame( blip_time_t );
+		void copy_state( Tracked_Blip_Buffer const&, blip_time_t in_time, blip_time_t own_time );
 	private:
 		blip_long last_non_silence;
 		void remove_( long );
@@ -151,6 +152,9 @@ public:
 
 	long samples_avail() const { return (bufs [0].samples_avail() - mixer.samples_read) * 2; }
 	long read_samples( blip_sample_t*, long );
+	
+	// See Blip_Buffer::copy_state()
+	void copy_state( Stereo_Buffer const&, blip_time_t in_time, blip_time_t own_time );
 
 private:
 	enum { bufs_size = 3 };
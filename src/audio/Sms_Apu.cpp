@@ -258,6 +258,40 @@ void Sms_Apu::end_frame( blip_time_t end_time )
 	last_time -= end_time;
 }
 
+void Sms_Apu::copy_state( Sms_Apu const& in )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Sms_Osc& osc = *oscs [i];
+		Sms_Osc const& src = *in.oscs [i];
+		osc.output_select = src.output_select;
+		osc.output = osc.outputs [osc.output_select];
+		osc.delay = src.delay;
+		osc.last_amp = src.last_amp;
+		osc.volume = src.volume;
+	}
+	
+	for ( int i = 0; i < 3; i++ )
+	{
+		squares [i].period = in.squares [i].period;
+		squares [i].phase = in.squares [i].phase;
+	}
+	
+	// noise period points to the shared table or to square 3 of its own APU
+	if ( in.noise.period == &in.squares [2].period )
+		noise.period = &squares [2].period;
+	else
+		noise.period = in.noise.period;
+	noise.shifter = in.noise.shifter;
+	noise.feedback = in.noise.feedback;
+	
+	last_time = in.last_time;
+	latch = in.latch;
+	noise_feedback = in.noise_feedback;
+	looped_feedback = in.looped_feedback;
+	ggstereo_save = in.ggstereo_save;
+}
+
 void Sms_Apu::write_ggstereo( blip_time_t time, int data )
 {
 	require( (unsigned) data <= 0xFF );
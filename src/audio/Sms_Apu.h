@@ -41,6 +41,9 @@ public:
 	// Run all oscillators up to specified time, end current frame, then
 	// start a new frame at time 0.
 	void end_frame( blip_time_t );
+	
+	// Copy registers and oscillator state from another APU, outputs are kept
+	void copy_state( Sms_Apu const& );
 
 public:
 	Sms_Apu();
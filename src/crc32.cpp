@@ -0,0 +1,276 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include "crc32.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define GS_CRC32_PCLMUL
+    #define GS_CRC32_PCLMUL_TARGET __attribute__((target("pclmul,sse2")))
+    #include <cpuid.h>
+    #include <emmintrin.h>
+    #include <wmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #define GS_CRC32_PCLMUL
+    #define GS_CRC32_PCLMUL_TARGET
+    #include <intrin.h>
+#endif
+
+#if defined(__ARM_FEATURE_CRC32) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    #define GS_CRC32_ARMV8
+    #include <arm_acle.h>
+#endif
+
+#define GS_CRC32_POLYNOMIAL 0xEDB88320
+
+typedef u32 (*CRC32Function)(u32 crc, const u8* buf, size_t size);
+
+// All implementations work on the inverted (internal) crc register.
+static u32 crc32_table[8][256];
+
+static u32 crc32_slice_by_8(u32 crc, const u8* p, size_t size)
+{
+    while (size >= 8)
+    {
+        u32 one = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<u32>(p[3]) << 24));
+        u32 two = p[4] | (p[5] << 8) | (p[6] << 16) | (static_cast<u32>(p[7]) << 24);
+
+        crc = crc32_table[7][one & 0xFF] ^
+              crc32_table[6][(one >> 8) & 0xFF] ^
+              crc32_table[5][(one >> 16) & 0xFF] ^
+              crc32_table[4][one >> 24] ^
+              crc32_table[3][two & 0xFF] ^
+              crc32_table[2][(two >> 8) & 0xFF] ^
+              crc32_table[1][(two >> 16) & 0xFF] ^
+              crc32_table[0][two >> 24];
+
+        p += 8;
+        size -= 8;
+    }
+
+    while (size--)
+        crc = crc32_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+#ifdef GS_CRC32_PCLMUL
+
+// Carry-less multiplication folding, "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ Instruction" (Intel, 2009).
+// Constants are for the bit-reflected CRC-32 polynomial.
+GS_CRC32_PCLMUL_TARGET
+static u32 crc32_pclmul_fold(u32 crc, const u8* p, size_t size)
+{
+    const __m128i k1k2 = _mm_set_epi32(0x00000001, 0xC6E41596, 0x00000001, 0x54442BD4);
+    const __m128i k3k4 = _mm_set_epi32(0x00000000, 0xCCAA009E, 0x00000001, 0x751997D0);
+    const __m128i k5k0 = _mm_set_epi32(0x00000000, 0x00000000, 0x00000001, 0x63CD6124);
+    const __m128i poly = _mm_set_epi32(0x00000001, 0xF7011641, 0x00000001, 0xDB710641);
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+    __m128i x5;
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+    p += 64;
+    size -= 64;
+
+    while (size >= 64)
+    {
+        __m128i x6, x7, x8;
+
+        x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30)));
+
+        p += 64;
+        size -= 64;
+    }
+
+    // Fold 512 bits into 128 bits
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (size >= 16)
+    {
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), x5);
+
+        p += 16;
+        size -= 16;
+    }
+
+    // Fold 128 bits into 64 bits
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_and_si128(x1, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<u32>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+
+static u32 crc32_pclmul(u32 crc, const u8* p, size_t size)
+{
+    if (size >= 64)
+    {
+        size_t chunk = size & ~static_cast<size_t>(15);
+        crc = crc32_pclmul_fold(crc, p, chunk);
+        p += chunk;
+        size -= chunk;
+    }
+
+    return crc32_slice_by_8(crc, p, size);
+}
+
+static bool crc32_pclmul_supported()
+{
+    unsigned int ecx, edx;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx = static_cast<unsigned int>(info[2]);
+    edx = static_cast<unsigned int>(info[3]);
+#else
+    unsigned int eax, ebx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+#endif
+    // PCLMULQDQ and SSE2
+    return (ecx & (1 << 1)) && (edx & (1 << 26));
+}
+
+#endif
+
+#ifdef GS_CRC32_ARMV8
+
+static u32 crc32_armv8(u32 crc, const u8* p, size_t size)
+{
+    while (size && (reinterpret_cast<uintptr_t>(p) & 7))
+    {
+        crc = __crc32b(crc, *p++);
+        size--;
+    }
+
+    while (size >= 8)
+    {
+        uint64_t data;
+        memcpy(&data, p, 8);
+        crc = __crc32d(crc, data);
+        p += 8;
+        size -= 8;
+    }
+
+    while (size--)
+        crc = __crc32b(crc, *p++);
+
+    return crc;
+}
+
+#endif
+
+struct CRC32Dispatch
+{
+    CRC32Function function;
+    const char* name;
+
+    CRC32Dispatch()
+    {
+        for (u32 i = 0; i < 256; i++)
+        {
+            u32 c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? (c >> 1) ^ GS_CRC32_POLYNOMIAL : c >> 1;
+            crc32_table[0][i] = c;
+        }
+
+        for (u32 i = 0; i < 256; i++)
+        {
+            for (int t = 1; t < 8; t++)
+                crc32_table[t][i] = (crc32_table[t - 1][i] >> 8) ^ crc32_table[0][crc32_table[t - 1][i] & 0xFF];
+        }
+
+        function = crc32_slice_by_8;
+        name = "slice-by-8";
+
+#if defined(GS_CRC32_ARMV8)
+        function = crc32_armv8;
+        name = "armv8";
+#elif defined(GS_CRC32_PCLMUL)
+        if (crc32_pclmul_supported())
+        {
+            function = crc32_pclmul;
+            name = "pclmul";
+        }
+#endif
+    }
+};
+
+static const CRC32Dispatch& GetCRC32Dispatch()
+{
+    // C++11 guarantees thread safe initialization of function statics
+    static const CRC32Dispatch dispatch;
+    return dispatch;
+}
+
+u32 CalculateCRC32(u32 crc, const u8* buf, int size)
+{
+    if (size <= 0)
+        return crc;
+
+    return ~GetCRC32Dispatch().function(~crc, buf, static_cast<size_t>(size));
+}
+
+const char* GetCRC32Implementation()
+{
+    return GetCRC32Dispatch().name;
+}
@@ -0,0 +1,32 @@
+/*
+ * Gearsystem - Sega Master System / Game Gear Emulator
+ * Copyright (C) 2013  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef CRC32_H
+#define	CRC32_H
+
+#include "definitions.h"
+
+// Standard CRC-32 (IEEE 802.3, reflected 0xEDB88320), same values as zlib.
+// Pass 0 as the initial crc, or a previous result to continue a stream.
+u32 CalculateCRC32(u32 crc, const u8* buf, int size);
+
+// Name of the implementation picked at runtime ("slice-by-8", "pclmul", "armv8").
+const char* GetCRC32Implementation();
+
+#endif	/* CRC32_H */
@@ -28,6 +28,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <atomic>
 
 #ifdef DEBUG
 #define DEBUG_GEARSYSTEM 1
@@ -118,6 +119,14 @@ struct GS_Color
     u8 blue;
 };
 
+enum GS_Pixel_Format
+{
+    Pixel_RGB888,
+    Pixel_Gray8,
+    Pixel_XRGB8888,
+    Pixel_RGB565
+};
+
 enum GS_Keys
 {
     Key_Up = 0,
@@ -156,30 +165,68 @@ struct GS_RuntimeInfo
     GS_Region region;
 };
 
+#define GS_LOG_ERROR 0
+#define GS_LOG_WARNING 1
+#define GS_LOG_INFO 2
+#define GS_LOG_DEBUG 3
+
+// Calls above this level are compiled out
+#ifndef GEARSYSTEM_LOG_LEVEL
+#define GEARSYSTEM_LOG_LEVEL GS_LOG_DEBUG
+#endif
+
+// Every call site prints at most this many messages per second, the
+// rest are counted and reported with its next printed message
+#define GS_LOG_RATE 8
+
+struct GS_Log_Site
+{
+    std::atomic<unsigned int> window;
+    std::atomic<unsigned int> count;
+    std::atomic<unsigned int> suppressed;
+};
+
+extern std::atomic<int> gs_log_level;
+
 #ifdef DEBUG_GEARSYSTEM
 #ifdef __ANDROID__
         #include <android/log.h>
         #define printf(...) __android_log_print(ANDROID_LOG_DEBUG, "GEARSYSTEM", __VA_ARGS__);
     #endif
-#define Log(msg, ...) (Log_func(msg, ##__VA_ARGS__))
+#define Log_Level(level, msg, ...) do { if ((level) <= GEARSYSTEM_LOG_LEVEL) { static GS_Log_Site log_site; unsigned int log_suppressed; if (Log_enabled(level, &log_site, log_suppressed)) Log_func(level, log_suppressed, msg, ##__VA_ARGS__); } } while (0)
 #else
-#define Log(msg, ...)
+#define Log_Level(level, msg, ...) do { } while (0)
 #endif
 
-inline void Log_func(const char* const msg, ...)
+#define Log(msg, ...) Log_Level(GS_LOG_INFO, msg, ##__VA_ARGS__)
+#define Log_Error(msg, ...) Log_Level(GS_LOG_ERROR, msg, ##__VA_ARGS__)
+#define Log_Warning(msg, ...) Log_Level(GS_LOG_WARNING, msg, ##__VA_ARGS__)
+#define Log_Debug(msg, ...) Log_Level(GS_LOG_DEBUG, msg, ##__VA_ARGS__)
+
+void Log_func(int level, unsigned int suppressed, const char* const msg, ...);
+void Log_set_level(int level);
+void Log_flush();
+unsigned int Log_window();
+
+inline bool Log_enabled(int level, GS_Log_Site* site, unsigned int& suppressed)
 {
-    static int count = 1;
-    char szBuf[512];
+    if (level > gs_log_level.load(std::memory_order_relaxed))
+        return false;
+
+    unsigned int window = Log_window();
+
+    if (site->window.exchange(window, std::memory_order_relaxed) != window)
+        site->count.store(0, std::memory_order_relaxed);
 
-    va_list args;
-    va_start(args, msg);
-    vsprintf(szBuf, msg, args);
-    va_end(args);
+    if (site->count.fetch_add(1, std::memory_order_relaxed) >= GS_LOG_RATE)
+    {
+        site->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
 
-    printf("%d: %s\n", count, szBuf);
-    fflush(stdout);
+    suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
 
-    count++;
+    return true;
 }
 
 inline u8 SetBit(const u8 value, const u8 bit)
@@ -30,6 +30,10 @@
 #include "SixteenBitRegister.h" 
 #include "EightBitRegister.h" 
 #include "MemoryRule.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "Watchpoints.h"
+#include "CheatSearch.h"
 
 #endif	/* GEARSYSTEM_H */
 
@@ -20,6 +20,8 @@
 #ifndef OPCODE_NAMES_H
 #define	OPCODE_NAMES_H
 
+#include "definitions.h"
+
 struct stOPCodeInfo
 {
     const char* name;
@@ -35,5 +37,92 @@ struct stOPCodeInfo
 #include "opcodeddcb_names.h"
 #include "opcodefdcb_names.h"
 
+// Formats the instruction in bytes, which holds every DD/FD prefix
+// followed by at least 5 more bytes. Returns the instruction size.
+static inline int FormatOPCode(const u8* bytes, u16 address, char* szName)
+{
+    u8 ddfd_mod = 0;
+    int first = 0;
+
+    while ((bytes[first] == 0xDD) || (bytes[first] == 0xFD))
+    {
+        ddfd_mod = bytes[first];
+        first++;
+    }
+
+    u8 opcode = bytes[first];
+    stOPCodeInfo info;
+
+    bool prefixed = false;
+
+    if (opcode == 0xCB)
+    {
+        prefixed = true;
+        if (ddfd_mod == 0xDD)
+        {
+            opcode = bytes[first + 2];
+            info = kOPCodeDDCBNames[opcode];
+        }
+        else if (ddfd_mod == 0xFD)
+        {
+            opcode = bytes[first + 2];
+            info = kOPCodeFDCBNames[opcode];
+        }
+        else
+        {
+            opcode = bytes[first + 1];
+            info = kOPCodeCBNames[opcode];
+        }
+    }
+    else if (opcode == 0xED)
+    {
+        prefixed = true;
+        opcode = bytes[first + 1];
+        info = kOPCodeEDNames[opcode];
+    }
+    else
+    {
+        if (ddfd_mod == 0xDD)
+            info = kOPCodeDDNames[opcode];
+        else if (ddfd_mod == 0xFD)
+            info = kOPCodeFDNames[opcode];
+        else
+            info = kOPCodeNames[opcode];
+    }
+
+    int size = info.size + (first > 1 ? (first - 1) : 0);
+
+    first += prefixed ? 1 : 0;
+
+    switch (info.type)
+    {
+        case 0:
+            strcpy(szName, info.name);
+            break;
+        case 1:
+            sprintf(szName, info.name, bytes[first]);
+            break;
+        case 2:
+            sprintf(szName, info.name, bytes[first + 1]);
+            break;
+        case 3:
+            sprintf(szName, info.name, (bytes[first + 2] << 8) | bytes[first + 1]);
+            break;
+        case 4:
+            sprintf(szName, info.name, (s8)bytes[first + 1]);
+            break;
+        case 5:
+            sprintf(szName, info.name, address + info.size + (s8)bytes[first + 1], (s8)bytes[first + 1]);
+            break;
+        case 6:
+            sprintf(szName, info.name, (s8)bytes[first + 1], bytes[first + 2]);
+            break;
+        default:
+            strcpy(szName, "PARSE ERROR");
+    }
+
+    return size;
+}
+
 #endif	/* OPCODE_NAMES_H */
 
@@ -30,9 +30,9 @@ void Processor::OPCode0x00()
 void Processor::OPCode0x01()
 {
     // LD BC,nn
-    OPCodes_LD(BC.GetLowRegister(), PC.GetValue());
+    OPCodes_LD(BC.GetLowRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
-    OPCodes_LD(BC.GetHighRegister(), PC.GetValue());
+    OPCodes_LD(BC.GetHighRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -65,7 +65,7 @@ void Processor::OPCode0x05()
 void Processor::OPCode0x06()
 {
     // LD B,n
-    OPCodes_LD(BC.GetHighRegister(), PC.GetValue());
+    OPCodes_LD(BC.GetHighRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -115,7 +115,7 @@ void Processor::OPCode0x0D()
 void Processor::OPCode0x0E()
 {
     // LD C,n
-    OPCodes_LD(BC.GetLowRegister(), PC.GetValue());
+    OPCodes_LD(BC.GetLowRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -135,9 +135,9 @@ void Processor::OPCode0x10()
 void Processor::OPCode0x11()
 {
     // LD DE,nn
-    OPCodes_LD(DE.GetLowRegister(), PC.GetValue());
+    OPCodes_LD(DE.GetLowRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
-    OPCodes_LD(DE.GetHighRegister(), PC.GetValue());
+    OPCodes_LD(DE.GetHighRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -170,7 +170,7 @@ void Processor::OPCode0x15()
 void Processor::OPCode0x16()
 {
     // LD D,n
-    OPCodes_LD(DE.GetHighRegister(), PC.GetValue());
+    OPCodes_LD(DE.GetHighRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -220,7 +220,7 @@ void Processor::OPCode0x1D()
 void Processor::OPCode0x1E()
 {
     // LD E,n
-    OPCodes_LD(DE.GetLowRegister(), PC.GetValue());
+    OPCodes_LD(DE.GetLowRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -240,9 +240,9 @@ void Processor::OPCode0x21()
 {
     // LD HL,nn
     SixteenBitRegister* reg = GetPrefixedRegister();
-    OPCodes_LD(reg->GetLowRegister(), PC.GetValue());
+    OPCodes_LD(reg->GetLowRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
-    OPCodes_LD(reg->GetHighRegister(), PC.GetValue());
+    OPCodes_LD(reg->GetHighRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -273,7 +273,7 @@ void Processor::OPCode0x25()
 void Processor::OPCode0x26()
 {
     // LD H,n
-    OPCodes_LD(GetPrefixedRegister()->GetHighRegister(), PC.GetValue());
+    OPCodes_LD(GetPrefixedRegister()->GetHighRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -330,7 +330,7 @@ void Processor::OPCode0x2D()
 void Processor::OPCode0x2E()
 {
     // LD L,n
-    OPCodes_LD(GetPrefixedRegister()->GetLowRegister(), PC.GetValue());
+    OPCodes_LD(GetPrefixedRegister()->GetLowRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 
 }
@@ -353,9 +353,9 @@ void Processor::OPCode0x30()
 void Processor::OPCode0x31()
 {
     // LD SP,nn
-    SP.SetLow(m_pMemory->Read(PC.GetValue()));
+    SP.SetLow(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
-    SP.SetHigh(m_pMemory->Read(PC.GetValue()));
+    SP.SetHigh(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -391,22 +391,22 @@ void Processor::OPCode0x36()
     // LD (HL),n  
     if (m_CurrentPrefix == 0xDD)
     {
-        u8 d = m_pMemory->Read(PC.GetValue());
-        u8 n = m_pMemory->Read(PC.GetValue() + 1);
+        u8 d = m_pMemory->FetchRead(PC.GetValue());
+        u8 n = m_pMemory->FetchRead(PC.GetValue() + 1);
         u16 address = IX.GetValue() + static_cast<s8> (d);
         m_pMemory->Write(address, n);
         PC.Increment();
     }
     else if (m_CurrentPrefix == 0xFD)
     {
-        u8 d = m_pMemory->Read(PC.GetValue());
-        u8 n = m_pMemory->Read(PC.GetValue() + 1);
+        u8 d = m_pMemory->FetchRead(PC.GetValue());
+        u8 n = m_pMemory->FetchRead(PC.GetValue() + 1);
         u16 address = IY.GetValue() + static_cast<s8> (d);
         m_pMemory->Write(address, n);
         PC.Increment();
     }
     else
-        m_pMemory->Write(HL.GetValue(), m_pMemory->Read(PC.GetValue()));
+        m_pMemory->Write(HL.GetValue(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -460,7 +460,7 @@ void Processor::OPCode0x3D()
 void Processor::OPCode0x3E()
 {
     // LD A,n
-    OPCodes_LD(AF.GetHighRegister(), PC.GetValue());
+    OPCodes_LD(AF.GetHighRegister(), m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1287,7 +1287,7 @@ void Processor::OPCode0xC5()
 void Processor::OPCode0xC6()
 {
     // ADD A,n
-    OPCodes_ADD(m_pMemory->Read(PC.GetValue()));
+    OPCodes_ADD(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1336,7 +1336,7 @@ void Processor::OPCode0xCD()
 void Processor::OPCode0xCE()
 {
     // ADC A,n
-    OPCodes_ADC(m_pMemory->Read(PC.GetValue()));
+    OPCodes_ADC(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1367,9 +1367,9 @@ void Processor::OPCode0xD2()
 void Processor::OPCode0xD3()
 {
     // OUT (n),A
-    u8 port = m_pMemory->Read(PC.GetValue());
+    u8 port = m_pMemory->FetchRead(PC.GetValue());
     PC.Increment();
-    m_pIOPorts->DoOutput(port, AF.GetHigh());
+    PortOutput(port, AF.GetHigh());
     WZ.SetLow((port + 1) & 0xFF);
     WZ.SetHigh(AF.GetHigh());
 }
@@ -1389,7 +1389,7 @@ void Processor::OPCode0xD5()
 void Processor::OPCode0xD6()
 {
     // SUB n
-    OPCodes_SUB(m_pMemory->Read(PC.GetValue()));
+    OPCodes_SUB(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1425,9 +1425,9 @@ void Processor::OPCode0xDB()
     if (m_bInputLastCycle)
     {
         u8 a = AF.GetHigh();
-        u8 port = m_pMemory->Read(PC.GetValue());
+        u8 port = m_pMemory->FetchRead(PC.GetValue());
         PC.Increment();
-        AF.SetHigh(m_pIOPorts->DoInput(port));
+        AF.SetHigh(PortInput(port));
         WZ.SetValue((a << 8) | (port + 1));
         m_iTStates -= 10;
         m_bInputLastCycle = false;
@@ -1455,7 +1455,7 @@ void Processor::OPCode0xDD()
 void Processor::OPCode0xDE()
 {
     // SBC n
-    OPCodes_SBC(m_pMemory->Read(PC.GetValue()));
+    OPCodes_SBC(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1511,7 +1511,7 @@ void Processor::OPCode0xE5()
 void Processor::OPCode0xE6()
 {
     // AND n
-    OPCodes_AND(m_pMemory->Read(PC.GetValue()));
+    OPCodes_AND(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1560,7 +1560,7 @@ void Processor::OPCode0xED()
 void Processor::OPCode0xEE()
 {
     // XOR n
-    OPCodes_XOR(m_pMemory->Read(PC.GetValue()));
+    OPCodes_XOR(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1610,7 +1610,7 @@ void Processor::OPCode0xF5()
 void Processor::OPCode0xF6()
 {
     // OR n
-    OPCodes_OR(m_pMemory->Read(PC.GetValue()));
+    OPCodes_OR(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 
@@ -1661,7 +1661,7 @@ void Processor::OPCode0xFD()
 void Processor::OPCode0xFE()
 {
     // CP n
-    OPCodes_CP(m_pMemory->Read(PC.GetValue()));
+    OPCodes_CP(m_pMemory->FetchRead(PC.GetValue()));
     PC.Increment();
 }
 